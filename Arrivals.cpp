@@ -0,0 +1,60 @@
+//
+//  Arrivals.cpp
+//  CloudSim
+//
+//  Folds task arrivals into batches. Every task schedules its own arrival event through
+//  ScheduleNewTask (hooked at link time with --wrap, see the Makefile). Arrivals that fall
+//  into the same delivery slot are chained to the first one, so the simulator fires one
+//  event and the scheduler receives the whole batch through HandleNewTasks().
+//
+//  SIM_ARRIVAL_WINDOW sets the slot width in microseconds. The default 0 batches tasks with
+//  identical arrival times only. With a width W, arrivals in [kW, (k+1)W) are delivered
+//  together at (k+1)W - 1, so a task is held back by less than W and never delivered early.
+//
+
+#include <cstdlib>
+#include <unordered_map>
+
+#include "Interfaces.h"
+#include "Internal_Interfaces.h"
+#include "Profile.h"
+
+extern void RealScheduleNewTask(Time_t time, TaskId_t task_id) asm("__real__Z15ScheduleNewTaskmj");
+void WrapScheduleNewTask(Time_t time, TaskId_t task_id) asm("__wrap__Z15ScheduleNewTaskmj");
+
+static unordered_map<Time_t, TaskId_t> leaders;                 // Delivery time -> task whose event delivers the batch
+static unordered_map<TaskId_t, vector<TaskId_t>> followers;     // Leader -> tasks folded into its event
+
+static Time_t ArrivalWindow() {
+    static Time_t window = Time_t(-1);
+    if (window == Time_t(-1)) {
+        const char * env = getenv("SIM_ARRIVAL_WINDOW");
+        window = env != nullptr ? Time_t(strtoull(env, nullptr, 10)) : 0;
+    }
+    return window;
+}
+
+void WrapScheduleNewTask(Time_t time, TaskId_t task_id) {
+    Time_t window = ArrivalWindow();
+    Time_t delivery = window == 0 ? time : (time / window + 1) * window - 1;
+
+    auto it = leaders.find(delivery);
+    if (it == leaders.end()) {
+        leaders[delivery] = task_id;
+        ProfileEvent(EVENT_TASK_ARRIVAL, delivery);
+        RealScheduleNewTask(delivery, task_id);
+    } else {
+        followers[it->second].push_back(task_id);
+    }
+}
+
+void Arrivals_TakeBatch(Time_t time, TaskId_t task_id, vector<TaskId_t> & batch) {
+    batch.clear();
+    batch.push_back(task_id);
+    auto it = followers.find(task_id);
+    if (it != followers.end()) {
+        batch.insert(batch.end(), it->second.begin(), it->second.end());
+        followers.erase(it);
+    }
+    leaders.erase(time);
+}
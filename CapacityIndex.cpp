@@ -0,0 +1,175 @@
+//
+//  CapacityIndex.cpp
+//  CloudSim
+//
+
+#include "CapacityIndex.hpp"
+#include "Internal_Interfaces.h"
+
+static unsigned FreeMemory(const MachineSlot_t & slot) {
+    return slot.memory_used < slot.memory_size ? slot.memory_size - slot.memory_used : 0;
+}
+
+void CapacityIndex::Init() {
+    unsigned total = Machine_GetTotal();
+    slots.resize(total);
+    buckets = vector<Bucket>(CPU_TYPES * 2 * S_STATES * 2);
+    up_cores = vector<unsigned>(CPU_TYPES * 2, 0);
+    busy_cores = vector<unsigned>(CPU_TYPES * 2, 0);
+    fenced_by_cpu = vector<Bucket>(CPU_TYPES);
+    for (unsigned i = 0; i < total; i++) {
+        // The only place the index reads Machine_GetInfo(), everything afterwards is tracked here
+        MachineInfo_t info = Machine_GetInfo(MachineId_t(i));
+        if (info.s_states.empty()) {
+            // Machine_GetInfo() leaves the S-state power table out, take the one it was added with
+            info.s_states = Workload_GetSStates(MachineId_t(i));
+        }
+        MachineSlot_t & slot = slots[i];
+        slot.cpu = info.cpu;
+        slot.gpus = info.gpus;
+        slot.num_cpus = info.num_cpus;
+        slot.memory_size = info.memory_size;
+        slot.memory_used = info.memory_used;
+        slot.active_tasks = info.active_tasks;
+        slot.active_vms = info.active_vms;
+        slot.s_state = info.s_state;
+        slot.p_state = info.p_state;
+        slot.class_id = InternClass(info);
+        slot.listed = true;
+        slot.fenced = false;
+        Link(MachineId_t(i));
+    }
+}
+
+/**
+ * Find a machine that is switched off.
+ * @returns the machine id, or -1 if every machine of that kind is up or on its way.
+ */
+MachineId_t CapacityIndex::FindAsleep(CPUType_t cpu, bool gpus) const {
+    const Bucket & bucket = buckets[BucketOf(cpu, gpus, S5, false)];
+    return bucket.empty() ? MachineId_t(-1) : bucket.begin()->second;
+}
+
+void CapacityIndex::AddMemory(MachineId_t machine_id, unsigned memory) {
+    Unlink(machine_id);
+    slots[machine_id].memory_used += memory;
+    Link(machine_id);
+}
+
+void CapacityIndex::RemoveMemory(MachineId_t machine_id, unsigned memory) {
+    Unlink(machine_id);
+    MachineSlot_t & slot = slots[machine_id];
+    slot.memory_used = slot.memory_used > memory ? slot.memory_used - memory : 0;
+    Link(machine_id);
+}
+
+void CapacityIndex::AddTask(MachineId_t machine_id) {
+    Unlink(machine_id);
+    slots[machine_id].active_tasks++;
+    Link(machine_id);
+}
+
+void CapacityIndex::RemoveTask(MachineId_t machine_id) {
+    Unlink(machine_id);
+    MachineSlot_t & slot = slots[machine_id];
+    if (slot.active_tasks > 0) {
+        slot.active_tasks--;
+    }
+    Link(machine_id);
+}
+
+void CapacityIndex::AddVM(MachineId_t machine_id) {
+    Unlink(machine_id);
+    slots[machine_id].active_vms++;
+    Link(machine_id);
+}
+
+void CapacityIndex::RemoveVM(MachineId_t machine_id) {
+    Unlink(machine_id);
+    MachineSlot_t & slot = slots[machine_id];
+    if (slot.active_vms > 0) {
+        slot.active_vms--;
+    }
+    Link(machine_id);
+}
+
+void CapacityIndex::SetListed(MachineId_t machine_id, bool listed) {
+    Unlink(machine_id);
+    slots[machine_id].listed = listed;
+    Link(machine_id);
+}
+
+void CapacityIndex::SetFenced(MachineId_t machine_id, bool fenced) {
+    Unlink(machine_id);
+    slots[machine_id].fenced = fenced;
+    Link(machine_id);
+}
+
+void CapacityIndex::SetState(MachineId_t machine_id, MachineState_t s_state) {
+    Unlink(machine_id);
+    slots[machine_id].s_state = s_state;
+    Link(machine_id);
+}
+
+// Machines of the same class share their tables, there are only a handful of classes
+unsigned CapacityIndex::InternClass(const MachineInfo_t & info) {
+    for (unsigned i = 0; i < classes.size(); i++) {
+        const MachineClass_t & c = classes[i];
+        if (c.num_cpus == info.num_cpus && c.cpu == info.cpu && c.memory_size == info.memory_size && c.gpus == info.gpus &&
+            c.performance == info.performance && c.c_states == info.c_states &&
+            c.p_states == info.p_states && c.s_states == info.s_states) {
+            return i;
+        }
+    }
+    classes.push_back({info.num_cpus, info.cpu, info.memory_size, info.gpus,
+                       info.performance, info.c_states, info.p_states, info.s_states});
+    return unsigned(classes.size() - 1);
+}
+
+unsigned CapacityIndex::BucketOf(CPUType_t cpu, bool gpus, MachineState_t s_state, bool saturated) {
+    return ((unsigned(cpu) * 2 + gpus) * S_STATES + unsigned(s_state)) * 2 + saturated;
+}
+
+unsigned CapacityIndex::BucketOf(const MachineSlot_t & slot) const {
+    return BucketOf(slot.cpu, slot.gpus, slot.s_state, slot.active_tasks >= slot.num_cpus);
+}
+
+void CapacityIndex::Unlink(MachineId_t machine_id) {
+    const MachineSlot_t & slot = slots[machine_id];
+    if (slot.listed) {
+        buckets[BucketOf(slot)].erase({FreeMemory(slot), machine_id});
+        idle.erase(machine_id);
+        light.erase(machine_id);
+    }
+    if (slot.fenced) {
+        fenced_by_cpu[slot.cpu].erase({slot.memory_used, machine_id});
+    }
+    unsigned group = unsigned(slot.cpu) * 2 + slot.gpus;
+    if (slot.s_state != S5) {
+        up_cores[group] -= slot.num_cpus;
+    }
+    busy_cores[group] -= slot.active_tasks;
+}
+
+void CapacityIndex::Link(MachineId_t machine_id) {
+    const MachineSlot_t & slot = slots[machine_id];
+    if (slot.listed) {
+        buckets[BucketOf(slot)].insert({FreeMemory(slot), machine_id});
+        if (slot.memory_used == 0 && slot.active_vms == 0 && slot.s_state != S5) {
+            idle.insert(machine_id);
+        }
+        if (slot.s_state == S0 && slot.active_vms > 0 && slot.active_tasks * 4 <= slot.num_cpus) {
+            light.insert(machine_id);
+        }
+    }
+    if (slot.fenced) {
+        fenced_by_cpu[slot.cpu].insert({slot.memory_used, machine_id});
+    }
+    // Fenced and draining machines are unlisted but their cores are up and their tasks are
+    // demand all the same
+    unsigned group = unsigned(slot.cpu) * 2 + slot.gpus;
+    if (slot.s_state != S5) {
+        up_cores[group] += slot.num_cpus;
+    }
+    busy_cores[group] += slot.active_tasks;
+}
@@ -0,0 +1,131 @@
+//
+//  CapacityIndex.hpp
+//  CloudSim
+//
+
+#ifndef CapacityIndex_hpp
+#define CapacityIndex_hpp
+
+#include <set>
+#include <vector>
+
+#include "Interfaces.h"
+
+// Bookkeeping the scheduler keeps for every machine. The static fields are read once
+// from Machine_GetInfo() at Init; the rest is maintained by the scheduler itself.
+typedef struct {
+    CPUType_t cpu;
+    bool gpus;
+    unsigned num_cpus;
+    unsigned memory_size;
+    unsigned memory_used;
+    unsigned active_tasks;
+    unsigned active_vms;
+    MachineState_t s_state;                 // The state the machine is in, or is heading to
+    CPUPerformance_t p_state;
+    unsigned class_id;                      // Index into the machine class table
+    bool listed;                            // False while the machine must not receive placements
+    bool fenced;                            // True from a memory warning until back under the high-water mark
+} MachineSlot_t;
+
+// Index of the cluster capacity, bucketed by CPU type, GPU flag, S-state and saturation
+// (one task per core), each bucket ordered by free memory. Every update is O(log n) and
+// a lookup visits a constant number of buckets. The index also tracks which listed machines
+// are up but hold nothing and which run at most a quarter of their cores, so periodic work
+// only visits those, how many cores each CPU type and GPU flavor has up and busy, and the
+// fenced machines of each CPU type in order of memory used.
+class CapacityIndex {
+public:
+    CapacityIndex()             {}
+    void Init();
+    const MachineSlot_t & Get(MachineId_t machine_id) const { return slots[machine_id]; }
+    const MachineClass_t & GetClass(MachineId_t machine_id) const { return classes[slots[machine_id].class_id]; }
+    const MachineClass_t & Class(unsigned class_id) const { return classes[class_id]; }
+    unsigned NumClasses() const { return unsigned(classes.size()); }
+    unsigned Size() const       { return unsigned(slots.size()); }
+    const set<MachineId_t> & Idle() const { return idle; }
+    const set<MachineId_t> & Light() const { return light; }
+    template <class Accept>
+    MachineId_t FindUp(bool gpus, unsigned memory, CPUType_t cpu, Accept accept) const;
+    MachineId_t FindAsleep(CPUType_t cpu, bool gpus) const;
+    const set<pair<unsigned, MachineId_t>> & FencedByMemory(CPUType_t cpu) const { return fenced_by_cpu[cpu]; }
+    template <class Visit>
+    void Candidates(unsigned memory, CPUType_t cpu, unsigned probes, Visit visit) const;
+    unsigned UpCores(CPUType_t cpu, bool gpus) const   { return up_cores[unsigned(cpu) * 2 + gpus]; }
+    unsigned BusyCores(CPUType_t cpu, bool gpus) const { return busy_cores[unsigned(cpu) * 2 + gpus]; }
+
+    void AddMemory(MachineId_t machine_id, unsigned memory);
+    void RemoveMemory(MachineId_t machine_id, unsigned memory);
+    void AddTask(MachineId_t machine_id);
+    void RemoveTask(MachineId_t machine_id);
+    void AddVM(MachineId_t machine_id);
+    void RemoveVM(MachineId_t machine_id);
+    void SetListed(MachineId_t machine_id, bool listed);
+    void SetFenced(MachineId_t machine_id, bool fenced);
+    void SetState(MachineId_t machine_id, MachineState_t s_state);
+    void SetPerformance(MachineId_t machine_id, CPUPerformance_t p_state) { slots[machine_id].p_state = p_state; }
+private:
+    typedef set<pair<unsigned, MachineId_t>> Bucket;
+
+    static unsigned BucketOf(CPUType_t cpu, bool gpus, MachineState_t s_state, bool saturated);
+    unsigned BucketOf(const MachineSlot_t & slot) const;
+    void Unlink(MachineId_t machine_id);
+    void Link(MachineId_t machine_id);
+    unsigned InternClass(const MachineInfo_t & info);
+
+    vector<MachineSlot_t> slots;
+    vector<MachineClass_t> classes;
+    vector<Bucket> buckets;
+    set<MachineId_t> idle;
+    set<MachineId_t> light;                 // Up machines with VMs and at most a quarter of their cores busy
+    vector<Bucket> fenced_by_cpu;           // Fenced machines by CPU type, ordered by memory used
+    vector<unsigned> up_cores;              // Cores of machines not in S5, by CPU type and GPU flavor
+    vector<unsigned> busy_cores;            // Tasks on every machine, by CPU type and GPU flavor
+};
+
+/**
+ * Best fit among the machines that are up and have a spare core, for callers that need more
+ * than memory to fit. Probes a bounded number of candidates in order of free memory.
+ * @param accept predicate on the machine id, false to skip the machine
+ * @returns the machine id, or -1 if no probed machine was accepted.
+ */
+template <class Accept>
+MachineId_t CapacityIndex::FindUp(bool gpus, unsigned memory, CPUType_t cpu, Accept accept) const {
+    const unsigned MAX_PROBES = 16;
+    const Bucket & bucket = buckets[BucketOf(cpu, gpus, S0, false)];
+    unsigned probes = 0;
+    for (auto it = bucket.lower_bound({memory, 0}); it != bucket.end() && probes < MAX_PROBES; ++it, ++probes) {
+        if (accept(it->second)) {
+            return it->second;
+        }
+    }
+    return MachineId_t(-1);
+}
+
+/**
+ * Visit the machines a task could go to. In every bucket of the CPU type with a spare core
+ * these are the best fits on free memory, in the saturated ones the machines with the most
+ * free memory, which spreads the load once every machine is saturated. A
+ * constant number of buckets is visited, each with a lookup and at most `probes` machines,
+ * all with room for the task.
+ * @param visit called with the id of each candidate
+ */
+template <class Visit>
+void CapacityIndex::Candidates(unsigned memory, CPUType_t cpu, unsigned probes, Visit visit) const {
+    for (unsigned gpus = 0; gpus < 2; gpus++) {
+        for (unsigned s = S0; s < S_STATES; s++) {
+            const Bucket & spare = buckets[BucketOf(cpu, gpus, MachineState_t(s), false)];
+            unsigned probed = 0;
+            for (auto it = spare.lower_bound({memory, 0}); it != spare.end() && probed < probes; ++it, ++probed) {
+                visit(it->second);
+            }
+            const Bucket & saturated = buckets[BucketOf(cpu, gpus, MachineState_t(s), true)];
+            probed = 0;
+            for (auto it = saturated.rbegin(); it != saturated.rend() && it->first >= memory && probed < probes; ++it, ++probed) {
+                visit(it->second);
+            }
+        }
+    }
+}
+
+#endif /* CapacityIndex_hpp */
@@ -0,0 +1,112 @@
+//
+//  Consolidation.cpp
+//  CloudSim
+//
+
+#include "Consolidation.hpp"
+#include "Tuning.h"
+
+// Assumed migration time until one has been seen (the simulator takes about 30 seconds,
+// whatever the size of the VM), and the weight of a new sample
+#define MIGRATION_GUESS_US          30000000.0
+#define MIGRATION_ALPHA             0.25
+
+void Consolidator::Init(const CapacityIndex & index) {
+    this->index = &index;
+    in_flight = 0;
+    latency = 0.0;
+    migrations = 0;
+    migration_time = 0.0;
+}
+
+unsigned Consolidator::Room() const {
+    unsigned max_migrations = unsigned(tuning.max_migrations);
+    return in_flight < max_migrations ? max_migrations - in_flight : 0;
+}
+
+unsigned Consolidator::Incoming(MachineId_t machine_id) const {
+    auto it = incoming.find(machine_id);
+    return it == incoming.end() ? 0 : it->second;
+}
+
+double Consolidator::MigrationTime() const {
+    return latency == 0.0 ? MIGRATION_GUESS_US : latency;
+}
+
+/**
+ * Decide whether moving a VM from source to target is worth its cost.
+ * @param tasks the tasks running in the VM
+ * @returns true if the tasks outlive the migration by tuning.migration_payback, every task with an SLA
+ * can absorb the migration and no GPU task loses its GPU.
+ */
+bool Consolidator::WorthMoving(Time_t now, MachineId_t source, MachineId_t target, const vector<TaskId_t> & tasks) const {
+    const MachineSlot_t & from = index->Get(source);
+    const MachineSlot_t & to = index->Get(target);
+    const vector<unsigned> & from_mips = index->GetClass(source).performance;
+    const vector<unsigned> & to_mips = index->GetClass(target).performance;
+    if (from_mips.size() != P_STATES || to_mips.size() != P_STATES) {
+        return false;
+    }
+    double move = MigrationTime();
+    double longest = 0.0;
+    for (TaskId_t task_id : tasks) {
+        TaskInfo_t info = GetTaskInfo(task_id);
+        if (info.completed) {
+            continue;
+        }
+        if (info.gpu_capable && from.gpus && !to.gpus) {
+            return false;
+        }
+        // MIPS are instructions per microsecond
+        longest = max(longest, double(info.remaining_instructions) / from_mips[from.p_state]);
+        if (info.required_sla != SLA3) {
+            double finish = double(now) + move + double(info.remaining_instructions) / to_mips[P0];
+            if (finish + move > double(info.target_completion)) {
+                return false;
+            }
+        }
+    }
+    return longest > move * tuning.migration_payback;
+}
+
+void Consolidator::Started(Time_t now, VMId_t vm_id, MachineId_t source, MachineId_t target, unsigned tasks) {
+    moves[vm_id] = {source, target, tasks, now};
+    draining[source]++;
+    incoming[target] += tasks;
+    in_flight++;
+}
+
+/**
+ * Record a completed migration.
+ * @returns true if the VM was the last one leaving its source machine.
+ */
+bool Consolidator::Completed(Time_t now, VMId_t vm_id) {
+    auto it = moves.find(vm_id);
+    if (it == moves.end()) {
+        return false;
+    }
+    const Move_t & move = it->second;
+    double elapsed = double(now - move.start);
+    latency = latency == 0.0 ? elapsed : MIGRATION_ALPHA * elapsed + (1 - MIGRATION_ALPHA) * latency;
+    migrations++;
+    migration_time += elapsed / 1000000;
+    in_flight--;
+
+    if ((incoming[move.target] -= move.tasks) == 0) {
+        incoming.erase(move.target);
+    }
+    bool drained = --draining[move.source] == 0;
+    if (drained) {
+        draining.erase(move.source);
+    }
+    moves.erase(it);
+    return drained;
+}
+
+void Consolidator::Report() const {
+    cout << "Consolidation migrations: " << migrations;
+    if (migrations > 0) {
+        cout << ", " << migration_time / migrations << " seconds on average";
+    }
+    cout << endl;
+}
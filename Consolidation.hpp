@@ -0,0 +1,52 @@
+//
+//  Consolidation.hpp
+//  CloudSim
+//
+
+#ifndef Consolidation_hpp
+#define Consolidation_hpp
+
+#include <map>
+#include <vector>
+
+#include "CapacityIndex.hpp"
+
+// Cost model and bookkeeping for packing the VMs of lightly loaded machines onto busier ones,
+// so whole machines empty out and can be powered down. A move pays off when the VM's tasks
+// outlive the migration by a wide margin, every task with an SLA keeps enough slack to absorb
+// it and GPU tasks keep their GPU. Migration time is learned from the completed migrations.
+// The scheduler picks donors and targets of the same CPU type with the cores and memory for
+// the VM, and runs the migrations; at most tuning.max_migrations are in flight at once.
+class Consolidator {
+public:
+    Consolidator()              {}
+    void Init(const CapacityIndex & index);
+    unsigned Room() const;
+    unsigned Incoming(MachineId_t machine_id) const;
+    bool Draining(MachineId_t machine_id) const { return draining.count(machine_id) != 0; }
+    bool WorthMoving(Time_t now, MachineId_t source, MachineId_t target, const vector<TaskId_t> & tasks) const;
+
+    void Started(Time_t now, VMId_t vm_id, MachineId_t source, MachineId_t target, unsigned tasks);
+    bool Completed(Time_t now, VMId_t vm_id);
+    void Report() const;
+private:
+    typedef struct {
+        MachineId_t source;
+        MachineId_t target;
+        unsigned tasks;                     // Cores the VM's tasks take at the target
+        Time_t start;
+    } Move_t;
+
+    double MigrationTime() const;
+
+    const CapacityIndex * index;
+    map<VMId_t, Move_t> moves;              // Migrations in flight
+    map<MachineId_t, unsigned> draining;    // VMs still leaving each donor
+    map<MachineId_t, unsigned> incoming;    // Cores promised to each target
+    unsigned in_flight;
+    double latency;                         // Moving average of the migration time in microseconds
+    unsigned migrations;
+    double migration_time;                  // Total seconds spent migrating
+};
+
+#endif /* Consolidation_hpp */
@@ -0,0 +1,102 @@
+//
+//  DVFS.cpp
+//  CloudSim
+//
+
+#include <limits>
+
+#include "DVFS.hpp"
+#include "Tuning.h"
+
+void DVFSController::Init(const CapacityIndex & index) {
+    this->index = &index;
+    loads = vector<Load_t>(index.Size());
+    for (Load_t & load : loads) {
+        load.warned = 0;
+    }
+}
+
+/**
+ * Select the P-state of a machine.
+ * @returns the P-state using the least energy per instruction among those keeping up with the
+ * pace of every task with an SLA, P0 if none does or one of the tasks was warned.
+ */
+CPUPerformance_t DVFSController::Select(Time_t now, MachineId_t machine_id) const {
+    const MachineSlot_t & slot = index->Get(machine_id);
+    const MachineClass_t & machine_class = index->GetClass(machine_id);
+    const vector<unsigned> & mips = machine_class.performance;
+    const Load_t & load = loads[machine_id];
+    if (mips.size() != P_STATES || load.warned > 0) {
+        return P0;
+    }
+    unsigned slowest = P3;
+    if (!load.targets.empty()) {
+        if (*load.targets.begin() <= now) {
+            return P0;
+        }
+        // Tasks beyond the number of cores share them
+        double share = slot.active_tasks > slot.num_cpus ? double(slot.num_cpus) / slot.active_tasks : 1.0;
+        double pace = *load.paces.rbegin();
+        // MIPS are instructions per microsecond
+        while (pace > mips[slowest] * share * tuning.slack_margin) {
+            if (slowest == P0) {
+                return P0;
+            }
+            slowest--;
+        }
+    }
+
+    // Slower is not always cheaper, a core also carries its part of the machine's S0 power for
+    // as long as it runs
+    const vector<unsigned> & power = machine_class.p_states;
+    if (power.size() != P_STATES || machine_class.s_states.size() != S_STATES) {
+        return CPUPerformance_t(slowest);
+    }
+    double machine_power = double(machine_class.s_states[S0]) / slot.num_cpus;
+    unsigned best = slowest;
+    for (unsigned p = P0; p < slowest; p++) {
+        if ((power[p] + machine_power) * mips[best] < (power[best] + machine_power) * mips[p]) {
+            best = p;
+        }
+    }
+    return CPUPerformance_t(best);
+}
+
+/**
+ * The pace of a task.
+ * @param start when the task can start running, after its machine is up
+ */
+TaskPace_t DVFSController::Pace(Time_t start, uint64_t instructions, Time_t target_completion, SLAType_t sla) {
+    if (sla == SLA3) {
+        return {0.0, 0, false};
+    }
+    double pace = target_completion > start ? double(instructions) / double(target_completion - start)
+                                            : numeric_limits<double>::max();
+    return {pace, target_completion, false};
+}
+
+void DVFSController::Add(MachineId_t machine_id, const TaskPace_t & pace) {
+    Load_t & load = loads[machine_id];
+    if (pace.target != 0) {
+        load.paces.insert(pace.pace);
+        load.targets.insert(pace.target);
+    }
+    load.warned += pace.warned;
+}
+
+void DVFSController::Remove(MachineId_t machine_id, const TaskPace_t & pace) {
+    Load_t & load = loads[machine_id];
+    if (pace.target != 0) {
+        load.paces.erase(load.paces.find(pace.pace));
+        load.targets.erase(load.targets.find(pace.target));
+    }
+    load.warned -= pace.warned;
+}
+
+// A machine running a task that got an SLA warning stays at P0 until the task leaves it
+void DVFSController::Warned(MachineId_t machine_id, TaskPace_t & pace) {
+    if (!pace.warned) {
+        pace.warned = true;
+        loads[machine_id].warned++;
+    }
+}
@@ -0,0 +1,49 @@
+//
+//  DVFS.hpp
+//  CloudSim
+//
+
+#ifndef DVFS_hpp
+#define DVFS_hpp
+
+#include <set>
+#include <vector>
+
+#include "CapacityIndex.hpp"
+
+// What DVFS keeps of a task, set when the task is placed
+typedef struct {
+    double pace;                            // Instructions per microsecond it needs to make its target
+    Time_t target;                          // Target completion, 0 for a task without an SLA
+    bool warned;                            // True once the task got an SLA warning
+} TaskPace_t;
+
+// Picks the P-state of a machine from the pace of the tasks it runs, the instructions per
+// microsecond a task with an SLA needs from its placement on to finish by its target
+// completion. A P-state qualifies when a task's share of the cores at that P-state keeps up
+// with the fastest pace on the machine. Of those, the one using the least energy per
+// instruction wins. Each machine keeps the paces and targets of its tasks ordered, so a task
+// joining or leaving is O(log k) and picking the P-state takes constant time. A machine
+// running a task past its target, or one that got an SLA warning, stays at P0.
+class DVFSController {
+public:
+    DVFSController()            {}
+    void Init(const CapacityIndex & index);
+    CPUPerformance_t Select(Time_t now, MachineId_t machine_id) const;
+    static TaskPace_t Pace(Time_t start, uint64_t instructions, Time_t target_completion, SLAType_t sla);
+
+    void Add(MachineId_t machine_id, const TaskPace_t & pace);
+    void Remove(MachineId_t machine_id, const TaskPace_t & pace);
+    void Warned(MachineId_t machine_id, TaskPace_t & pace);
+private:
+    typedef struct {
+        multiset<double> paces;
+        multiset<Time_t> targets;
+        unsigned warned;                    // Tasks that got an SLA warning
+    } Load_t;
+
+    const CapacityIndex * index;
+    vector<Load_t> loads;                   // By machine
+};
+
+#endif /* DVFS_hpp */
@@ -0,0 +1,230 @@
+//
+//  EventBench.cpp
+//  CloudSim
+//
+//  Microbenchmark of the simulator's event queue. Simulator::Simulate keeps its pending events
+//  in a std::priority_queue of shared_ptr<Event>, each made with make_shared, and that lives in
+//  the prebuilt Simulator.o where it cannot be swapped out. This replays the events of real
+//  runs, recorded with SIM_EVENT_TRACE (Profile.h), through a copy of that queue and through
+//  the alternatives, and checks that all of them hand the events back in the same order:
+//
+//      heap      std::priority_queue<shared_ptr<Event>>, as in Simulator.o
+//      pooled    std::priority_queue of due times and indices into a pool of event nodes
+//      radix     EventQueue.hpp, a radix heap over a pool of event nodes
+//
+//  A trace holds the events in the order they were scheduled, each with the time it was
+//  scheduled at and the time it is due. The replay pops every event due by the time the next
+//  one was scheduled, then pushes that one, and drains the queue at the end, so the queue
+//  holds what the simulator's held at every push. eventbench.sh records the traces and runs
+//  this on them.
+//
+//  Usage: ./eventbench [-r repeats] trace...
+//
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <queue>
+#include <unistd.h>
+
+#include "EventQueue.hpp"
+
+typedef struct {
+    Time_t now;                             // When the event was scheduled
+    Time_t time;                            // When it is due
+} Record_t;
+
+// The payload the simulator's events carry: the largest, a task completion, names a machine
+// and a core
+typedef struct {
+    unsigned machine_id;
+    unsigned core_id;
+} Payload_t;
+
+// The queue of Simulator.o
+
+class Event {
+public:
+    Event(Time_t time) : time(time) {}
+    virtual ~Event() {}
+    virtual void Execute() = 0;
+    Time_t time;
+};
+
+class CompletionEvent : public Event {
+public:
+    CompletionEvent(Time_t time, Payload_t payload) : Event(time), payload(payload) {}
+    void Execute() {}
+    Payload_t payload;
+};
+
+class HeapQueue {
+public:
+    bool Empty() const          { return heap.empty(); }
+    void Push(Time_t time, const Payload_t & payload) { heap.push(make_shared<CompletionEvent>(time, payload)); }
+    Time_t Top() const          { return heap.top()->time; }
+    void Pop()                  { heap.pop(); }
+private:
+    struct EventComparator {
+        bool operator()(const shared_ptr<Event> & a, const shared_ptr<Event> & b) const { return a->time > b->time; }
+    };
+    priority_queue<shared_ptr<Event>, vector<shared_ptr<Event>>, EventComparator> heap;
+};
+
+// The same binary heap without the allocations
+
+class PooledQueue {
+public:
+    bool Empty() const          { return heap.empty(); }
+    void Push(Time_t time, const Payload_t & payload);
+    Time_t Top() const          { return heap.top().first; }
+    void Pop();
+private:
+    priority_queue<pair<Time_t, unsigned>, vector<pair<Time_t, unsigned>>, greater<pair<Time_t, unsigned>>> heap;
+    vector<Payload_t> nodes;
+    vector<unsigned> free_nodes;
+};
+
+void PooledQueue::Push(Time_t time, const Payload_t & payload) {
+    unsigned node;
+    if (free_nodes.empty()) {
+        node = unsigned(nodes.size());
+        nodes.push_back(payload);
+    } else {
+        node = free_nodes.back();
+        free_nodes.pop_back();
+        nodes[node] = payload;
+    }
+    heap.push({time, node});
+}
+
+void PooledQueue::Pop() {
+    free_nodes.push_back(heap.top().second);
+    heap.pop();
+}
+
+class RadixQueue {
+public:
+    bool Empty() const          { return queue.Empty(); }
+    void Push(Time_t time, const Payload_t & payload) { queue.Push(time, payload); }
+    Time_t Top()                { return queue.Top(); }
+    void Pop()                  { queue.Pop(); }
+private:
+    EventQueue<Payload_t> queue;
+};
+
+// Replay
+
+typedef struct {
+    double seconds;                         // Fastest of the repeats
+    uint64_t order;                         // Hash of the due times in the order they were popped
+} Result_t;
+
+template <typename Queue>
+static Result_t Replay(const vector<Record_t> & trace, unsigned repeats) {
+    Result_t result = {0, 0};
+    for (unsigned r = 0; r < repeats; r++) {
+        uint64_t order = 0;
+        auto start = chrono::steady_clock::now();
+        {
+            Queue queue;
+            for (size_t i = 0; i < trace.size(); i++) {
+                while (!queue.Empty() && queue.Top() <= trace[i].now) {
+                    order = order * 1000003 + queue.Top();
+                    queue.Pop();
+                }
+                queue.Push(trace[i].time, {unsigned(i), unsigned(i >> 32)});
+            }
+            while (!queue.Empty()) {
+                order = order * 1000003 + queue.Top();
+                queue.Pop();
+            }
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (r == 0 || seconds < result.seconds) {
+            result.seconds = seconds;
+        }
+        result.order = order;
+    }
+    return result;
+}
+
+// The simulator takes no event due before the one it is running, an event due in the past
+// runs next. The replay does the same, and each queue counts on it.
+static vector<Record_t> Load(const char * path, unsigned & late) {
+    ifstream in(path, ios::binary);
+    if (!in) {
+        fprintf(stderr, "eventbench: Unable to open %s\n", path);
+        exit(1);
+    }
+    vector<Record_t> trace;
+    Record_t record;
+    Time_t now = 0;
+    late = 0;
+    while (in.read(reinterpret_cast<char *>(&record), sizeof(record))) {
+        now = max(now, record.now);
+        record.now = now;
+        if (record.time < now) {
+            record.time = now;
+            late++;
+        }
+        trace.push_back(record);
+    }
+    return trace;
+}
+
+// Largest number of events pending at once
+static size_t Pending(const vector<Record_t> & trace) {
+    priority_queue<Time_t, vector<Time_t>, greater<Time_t>> heap;
+    size_t most = 0;
+    for (const Record_t & record : trace) {
+        while (!heap.empty() && heap.top() <= record.now) {
+            heap.pop();
+        }
+        heap.push(record.time);
+        most = max(most, heap.size());
+    }
+    return most;
+}
+
+static void Report(const char * name, const Result_t & result, const Result_t & base, size_t events) {
+    printf("  %-8s %10.3f ms %8.1f ns per event  x%.2f\n", name, result.seconds * 1e3,
+           events > 0 ? result.seconds * 1e9 / events : 0.0, result.seconds > 0 ? base.seconds / result.seconds : 0.0);
+}
+
+int main(int argc, char * argv[]) {
+    unsigned repeats = 5;
+    int opt;
+    while ((opt = getopt(argc, argv, "r:")) != -1) {
+        if (opt == 'r') {
+            repeats = max(1, atoi(optarg));
+        } else {
+            fprintf(stderr, "Usage: %s [-r repeats] trace...\n", argv[0]);
+            return 1;
+        }
+    }
+    if (optind == argc) {
+        fprintf(stderr, "Usage: %s [-r repeats] trace...\n", argv[0]);
+        return 1;
+    }
+
+    int status = 0;
+    for (int a = optind; a < argc; a++) {
+        unsigned late;
+        vector<Record_t> trace = Load(argv[a], late);
+        printf("%s: %zu events, at most %zu pending, %u due before they were scheduled\n", argv[a], trace.size(), Pending(trace), late);
+
+        Result_t heap = Replay<HeapQueue>(trace, repeats);
+        Result_t pooled = Replay<PooledQueue>(trace, repeats);
+        Result_t radix = Replay<RadixQueue>(trace, repeats);
+        Report("heap", heap, heap, trace.size());
+        Report("pooled", pooled, heap, trace.size());
+        Report("radix", radix, heap, trace.size());
+        if (pooled.order != heap.order || radix.order != heap.order) {
+            printf("  the queues popped the events in different orders\n");
+            status = 1;
+        }
+    }
+    return status;
+}
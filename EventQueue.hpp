@@ -0,0 +1,121 @@
+//
+//  EventQueue.hpp
+//  CloudSim
+//
+
+#ifndef EventQueue_hpp
+#define EventQueue_hpp
+
+#include <cassert>
+#include <vector>
+
+#include "SimTypes.h"
+
+// Queue of pending events keyed by the simulated time they are due, for a simulator whose
+// clock never goes backwards: no event is pushed due before the last one popped. It is a
+// radix heap. Bucket b holds the events whose due time first differs from the last popped
+// time in bit b-1, and bucket 0 the ones due at that time. A push is O(1). A pop that finds
+// bucket 0 empty moves the lowest nonempty bucket down, and since every event only moves to
+// lower buckets, each costs O(log T) over its lifetime, T the span of the times. The events
+// themselves live in a pool of nodes that is reused, so the queue does not allocate once it
+// has grown to the largest number pending. Top() only looks: the last popped time stays the
+// floor for pushes, so an event may still be pushed due before the one Top() returned. Events
+// due at the same time come out in no particular order, as they do from the simulator's heap.
+template <typename Payload>
+class EventQueue {
+public:
+    EventQueue() : last(0), pending(0), earliest(0), earliest_known(true) {}
+    bool Empty() const          { return pending == 0; }
+    unsigned Size() const       { return pending; }
+    void Push(Time_t time, const Payload & payload);
+    Time_t Top();
+    Payload Pop();
+private:
+    typedef struct {
+        Time_t time;
+        Payload payload;
+    } Node_t;
+
+    static const unsigned BUCKETS = 65;
+
+    unsigned Bucket(Time_t time) const  { return time == last ? 0 : 64 - __builtin_clzll(time ^ last); }
+    void Settle();
+
+    Time_t last;                            // Due time of the last event popped
+    unsigned pending;
+    Time_t earliest;                        // Due time of the next event, kept from Top() until the next Pop()
+    bool earliest_known;
+    vector<Node_t> nodes;
+    vector<unsigned> free_nodes;
+    vector<unsigned> buckets[BUCKETS];      // Indices into nodes
+};
+
+template <typename Payload>
+void EventQueue<Payload>::Push(Time_t time, const Payload & payload) {
+    assert(time >= last);
+    unsigned node;
+    if (free_nodes.empty()) {
+        node = unsigned(nodes.size());
+        nodes.push_back({time, payload});
+    } else {
+        node = free_nodes.back();
+        free_nodes.pop_back();
+        nodes[node] = {time, payload};
+    }
+    buckets[Bucket(time)].push_back(node);
+    if (pending == 0 || time < earliest) {
+        earliest = time;
+        earliest_known = earliest_known || pending == 0;
+    }
+    pending++;
+}
+
+// Due time of the next event, the minimum of the lowest nonempty bucket
+template <typename Payload>
+Time_t EventQueue<Payload>::Top() {
+    assert(pending > 0);
+    if (!earliest_known) {
+        unsigned b = 0;
+        while (buckets[b].empty()) {
+            b++;
+        }
+        earliest = nodes[buckets[b][0]].time;
+        for (unsigned node : buckets[b]) {
+            earliest = min(earliest, nodes[node].time);
+        }
+        earliest_known = true;
+    }
+    return earliest;
+}
+
+// Bring the next events into bucket 0, making their due time the last popped
+template <typename Payload>
+void EventQueue<Payload>::Settle() {
+    if (!buckets[0].empty()) {
+        return;
+    }
+    unsigned b = 1;
+    while (buckets[b].empty()) {
+        b++;
+    }
+    last = Top();
+    for (unsigned node : buckets[b]) {
+        buckets[Bucket(nodes[node].time)].push_back(node);
+    }
+    buckets[b].clear();
+}
+
+template <typename Payload>
+Payload EventQueue<Payload>::Pop() {
+    assert(pending > 0);
+    Settle();
+    unsigned node = buckets[0].back();
+    buckets[0].pop_back();
+    free_nodes.push_back(node);
+    pending--;
+    earliest = last;
+    earliest_known = !buckets[0].empty();
+    return nodes[node].payload;
+}
+
+#endif /* EventQueue_hpp */
@@ -30,7 +30,7 @@ extern void             ThrowException(string err_msg, unsigned further_input);
 extern CPUType_t        Machine_GetCPUType(MachineId_t machine_id);
 extern uint64_t         Machine_GetEnergy(MachineId_t machine_id);
 extern double           Machine_GetClusterEnergy();
-extern MachineInfo_t    Machine_GetInfo(MachineId_t machine_id);
+extern MachineInfo_t    Machine_GetInfo(MachineId_t machine_id);            // Copies the static power and performance tables, the scheduler reads it once (CapacityIndex)
 extern unsigned         Machine_GetTotal();
 extern void             Machine_SetCorePerformance(MachineId_t machine_id, unsigned core_id, CPUPerformance_t p_state);  // This is oriented toward dynamic energy
 extern void             Machine_SetState(MachineId_t machine_id, MachineState_t s_state);
@@ -38,6 +38,7 @@ extern void             Machine_SetState(MachineId_t machine_id, MachineState_t
 // Scheduler Interface
 extern void             InitScheduler();                                    // Called once at the beginning
 extern void             HandleNewTask(Time_t time, TaskId_t task_id);       // Called every time a new task arrives to the system
+extern void             HandleNewTasks(Time_t time, const vector<TaskId_t> & task_ids); // Called with all the tasks arriving in the same slot
 extern void             HandleTaskCompletion(Time_t time, TaskId_t task_id);// Called whenver a task finishes
 extern void             MemoryWarning(Time_t time, MachineId_t machine_id); // Called to alert the scheduler of memory overcommitment
 extern void             MigrationDone(Time_t time, VMId_t vm_id);           // Called to alert the scheduler that the VM has been migrated successfully
@@ -69,7 +70,7 @@ extern void             SetTaskPriority(TaskId_t task_id, Priority_t priority);
 extern void             VM_Attach(VMId_t vm_id, MachineId_t machine_id);
 extern void             VM_AddTask(VMId_t vm_id, TaskId_t task_id, Priority_t priority);
 extern VMId_t           VM_Create(VMType_t vm_type, CPUType_t cpu);
-extern VMInfo_t         VM_GetInfo(VMId_t vm_id);
+extern VMInfo_t         VM_GetInfo(VMId_t vm_id);                           // Copies active_tasks, the scheduler keeps its own (VMRecord_t)
 extern void             VM_Migrate(VMId_t vm_id, MachineId_t machine_id);
 extern void             VM_RemoveTask(VMId_t vm_id, TaskId_t task_id);
 extern void             VM_Shutdown(VMId_t vm_id);
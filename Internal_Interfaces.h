@@ -21,6 +21,9 @@ void CPU_AbortTask(CPUId_t cpu_id);
 Time_t CPU_RunTask(CPUId_t cpu_id, TaskId_t task_id);
 void CPU_StopTask(CPUId_t cpu_id);
 
+// Arrival batching interface
+extern void Arrivals_TakeBatch(Time_t time, TaskId_t task_id, vector<TaskId_t> & batch);
+
 // Initializer interface
 extern void Init(string filename);
 
@@ -36,6 +39,10 @@ extern void Machine_AttachTask(MachineId_t machine_id, TaskId_t task_id, VMId_t
 extern void Machine_HandleTimer(Time_t time);
 extern void Machine_MigrateVM(VMId_t vm_id, MachineId_t current, MachineId_t next);
 
+// Workload capture interface
+extern const vector<unsigned> & Workload_GetSStates(MachineId_t machine_id);
+extern void Workload_Stream(Time_t now, unsigned delivered);
+
 // Internal Simulator Interface
 extern void StartSimulation();
 extern void ScheduleMigrationCompletion(Time_t time, VMId_t vm_id);
@@ -0,0 +1,128 @@
+//
+//  Logging.cpp
+//  CloudSim
+//
+
+#include <climits>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+#include "Logging.h"
+
+// Until LogInit() runs every message is handed to SimOutput(), which applies the real level
+unsigned log_level = UINT_MAX;
+
+// Buffered writer for the verbose levels. Producers append to the front buffer under a short
+// lock, the writer thread swaps buffers and does the file I/O outside of the lock.
+class AsyncSink {
+public:
+    AsyncSink(FILE * out) : out(out), done(false) {
+        writer = thread(&AsyncSink::Run, this);
+    }
+    ~AsyncSink() {
+        {
+            lock_guard<mutex> lock(m);
+            done = true;
+        }
+        cv.notify_one();
+        writer.join();
+        fclose(out);
+    }
+    void Push(const string & msg) {
+        bool wake;
+        {
+            lock_guard<mutex> lock(m);
+            front += msg;
+            front += '\n';
+            wake = front.size() >= FLUSH_BYTES;
+        }
+        if (wake) {
+            cv.notify_one();
+        }
+    }
+private:
+    static const size_t FLUSH_BYTES = 1 << 20;
+
+    void Run() {
+        unique_lock<mutex> lock(m);
+        while (true) {
+            cv.wait(lock, [this] { return done || front.size() >= FLUSH_BYTES; });
+            bool stop = done;
+            swap(front, back);
+            lock.unlock();
+            fwrite(back.data(), 1, back.size(), out);
+            back.clear();
+            lock.lock();
+            if (stop) {
+                break;
+            }
+        }
+        fflush(out);
+    }
+
+    FILE * out;
+    string front;
+    string back;
+    mutex m;
+    condition_variable cv;
+    thread writer;
+    bool done;
+};
+
+static AsyncSink * sink = nullptr;
+
+// main.o keeps its -v level to itself, so mirror its argument handling:
+// "simulator input_file" runs at level 0 and "simulator -v level input_file" at that level.
+static unsigned ReadVerboseLevel() {
+    const char * env = getenv("SIM_VERBOSE");
+    if (env != nullptr) {
+        return unsigned(atoi(env));
+    }
+
+    ifstream cmdline("/proc/self/cmdline");
+    if (!cmdline) {
+        return UINT_MAX;
+    }
+    vector<string> args;
+    string arg;
+    while (getline(cmdline, arg, '\0')) {
+        args.push_back(arg);
+    }
+    if (args.size() == 2) {
+        return 0;
+    }
+    if (args.size() == 4 && args[1] == "-v") {
+        return unsigned(atoi(args[2].c_str()));
+    }
+    return UINT_MAX;
+}
+
+void LogInit() {
+    log_level = ReadVerboseLevel();
+
+    const char * path = getenv("SIM_LOG_FILE");
+    if (path != nullptr && sink == nullptr) {
+        FILE * out = fopen(path, "w");
+        if (out == nullptr) {
+            ThrowException("LogInit(): Unable to open log file ", string(path));
+        }
+        sink = new AsyncSink(out);
+    }
+}
+
+void LogShutdown() {
+    delete sink;
+    sink = nullptr;
+}
+
+void LogWrite(unsigned level, string & msg) {
+    if (sink != nullptr && level >= LOG_ASYNC_LEVEL) {
+        sink->Push(msg);
+    } else {
+        SimOutput(msg, level);
+    }
+}
@@ -0,0 +1,66 @@
+//
+//  Logging.h
+//  CloudSim
+//
+
+#ifndef Logging_h
+#define Logging_h
+
+// Level-gated logging for the scheduler. SIM_LOG checks the level before any argument is
+// evaluated or formatted, so disabled messages cost a compare and a branch:
+//
+//     SIM_LOG(3, "Task ", task_id, " placed on machine ", machine_id);
+//
+// The runtime level follows the simulator's -v flag. Levels above LOG_MAX_LEVEL are
+// compiled out entirely. Setting SIM_LOG_FILE sends messages at LOG_ASYNC_LEVEL and above
+// to that file through a buffered background writer instead of SimOutput().
+
+#include <charconv>
+#include <string>
+#include <type_traits>
+
+#include "Interfaces.h"
+
+#ifndef LOG_MAX_LEVEL
+#define LOG_MAX_LEVEL 4
+#endif
+
+#ifndef LOG_ASYNC_LEVEL
+#define LOG_ASYNC_LEVEL 3
+#endif
+
+extern unsigned log_level;
+
+extern void LogInit();
+extern void LogShutdown();
+extern void LogWrite(unsigned level, string & msg);
+
+inline void LogAppend(string & out, const char * s)     { out += s; }
+inline void LogAppend(string & out, const string & s)   { out += s; }
+inline void LogAppend(string & out, char c)             { out += c; }
+inline void LogAppend(string & out, bool b)             { out += b ? "true" : "false"; }
+inline void LogAppend(string & out, double d)           { out += to_string(d); }
+
+template <typename T, typename = enable_if_t<is_integral<T>::value || is_enum<T>::value>>
+inline void LogAppend(string & out, T value) {
+    char buf[24];
+    auto res = to_chars(buf, buf + sizeof(buf), static_cast<conditional_t<is_enum<T>::value, int, T>>(value));
+    out.append(buf, res.ptr);
+}
+
+template <typename... Args>
+void LogMessage(unsigned level, const Args &... args) {
+    static thread_local string msg;
+    msg.clear();
+    (LogAppend(msg, args), ...);
+    LogWrite(level, msg);
+}
+
+#define SIM_LOG(level, ...)                                                     \
+    do {                                                                        \
+        if ((level) <= LOG_MAX_LEVEL && (level) <= log_level) {                 \
+            LogMessage((level), __VA_ARGS__);                                   \
+        }                                                                       \
+    } while (0)
+
+#endif /* Logging_h */
@@ -0,0 +1,128 @@
+//
+//  Placement.cpp
+//  CloudSim
+//
+
+#include <algorithm>
+#include <limits>
+
+#include "Placement.hpp"
+
+// Best fits probed in each bucket of the capacity index
+#define PROBES      2
+
+enum {
+    TIER_FIT,                               // Makes its target on a core of its own, GPU flavor as asked
+    TIER_OTHER_FLAVOR,                      // The same on a machine of the other GPU flavor
+    TIER_SHARED,                            // Makes its target sharing cores with the machine's tasks
+    TIER_LATE,                              // Misses its target
+    TIER_LATE_WAKING                        // Misses its target on a machine that has yet to wake up
+};
+
+static bool Better(const Score_t & lhs, const Score_t & rhs) {
+    return lhs.tier < rhs.tier || (lhs.tier == rhs.tier && lhs.cost < rhs.cost);
+}
+
+void PlacementModel::Init(const CapacityIndex & index, const PowerManager & power) {
+    this->index = &index;
+    this->power = &power;
+    classes.resize(index.NumClasses());
+    for (unsigned c = 0; c < classes.size(); c++) {
+        const MachineClass_t & machine_class = index.Class(c);
+        ClassCost_t & cost = classes[c];
+        cost.valid = machine_class.performance.size() == P_STATES && machine_class.p_states.size() == P_STATES &&
+                     machine_class.s_states.size() == S_STATES && machine_class.c_states.size() > C1 &&
+                     machine_class.num_cpus > 0;
+        if (!cost.valid) {
+            continue;
+        }
+        double s0_share = double(machine_class.s_states[S0]) / machine_class.num_cpus;
+        for (unsigned p = P0; p < P_STATES; p++) {
+            cost.mips[p] = max(double(machine_class.performance[p]), 1.0);
+            double busy = double(machine_class.p_states[p]) - double(machine_class.c_states[C1]);
+            cost.core_energy[p] = max(busy, 0.0) / cost.mips[p];
+            cost.machine_energy[p] = (machine_class.p_states[p] + s0_share) / cost.mips[p];
+            cost.order[p] = CPUPerformance_t(p);
+        }
+        for (unsigned s = S0; s < S_STATES; s++) {
+            cost.s_power[s] = machine_class.s_states[s];
+        }
+        stable_sort(cost.order, cost.order + P_STATES, [&cost](CPUPerformance_t lhs, CPUPerformance_t rhs) {
+            return cost.machine_energy[lhs] < cost.machine_energy[rhs];
+        });
+    }
+}
+
+/**
+ * Score placing a task on a machine.
+ * @returns the tier and cost of the placement (see Score_t).
+ */
+Score_t PlacementModel::Score(Time_t now, const Demand_t & demand, MachineId_t machine_id) const {
+    const MachineSlot_t & slot = index->Get(machine_id);
+    const ClassCost_t & cost = classes[slot.class_id];
+    if (!cost.valid) {
+        return {TIER_LATE, numeric_limits<double>::max()};
+    }
+    double delay = double(power->WakeDelay(now, machine_id));
+    // Tasks beyond the number of cores share them
+    bool shared = slot.active_tasks >= slot.num_cpus;
+    double share = shared ? double(slot.num_cpus) / (slot.active_tasks + 1) : 1.0;
+    double instructions = double(demand.instructions);
+    // Tasks beyond the number of cores queue for them, which stretches the run time of the task
+    // by their share of the cores
+    double queueing = shared ? double(slot.active_tasks + 1 - slot.num_cpus) / slot.num_cpus * instructions / cost.mips[P0]
+                             : 0.0;
+
+    double budget = demand.sla == SLA3 ? numeric_limits<double>::max()
+                                       : double(demand.target_completion) - double(now) - delay;
+    unsigned p = P_STATES;
+    for (CPUPerformance_t candidate : cost.order) {
+        if (budget > 0 && instructions <= cost.mips[candidate] * share * budget) {
+            p = candidate;
+            break;
+        }
+    }
+    // On a saturated machine the task is placed where it is done soonest, which spreads the
+    // load over the saturated machines rather than piling it on the cheapest one
+    double finish = delay + queueing + instructions / cost.mips[P0];
+    if (p == P_STATES) {
+        double lateness = finish - (double(demand.target_completion) - double(now));
+        return {delay > 0 ? TIER_LATE_WAKING : TIER_LATE, lateness};
+    }
+    if (shared) {
+        return {TIER_SHARED, finish};
+    }
+
+    double run_time = instructions / cost.mips[p];
+    // A task on a core of its own only adds what the core draws above idle
+    double energy = instructions * cost.core_energy[p];
+    // A machine that is asleep draws its S0 power from the wake-up until the task is done
+    energy += (cost.s_power[S0] - cost.s_power[slot.s_state]) * (delay + run_time);
+
+    unsigned tier = slot.gpus == demand.gpu ? TIER_FIT : TIER_OTHER_FLAVOR;
+    return {tier, energy};
+}
+
+/**
+ * Find the machine where a task costs the least. A machine that has yet to wake up and where
+ * the task would miss its target is not taken while machines of the task's CPU type are up,
+ * the task queues for room on one of those instead.
+ * @returns the machine id, or -1 if no machine of the task's CPU type has room for it.
+ */
+MachineId_t PlacementModel::Find(Time_t now, const Demand_t & demand) const {
+    MachineId_t best = MachineId_t(-1);
+    Score_t best_score = {TIER_LATE, numeric_limits<double>::max()};
+    index->Candidates(demand.memory, demand.cpu, PROBES, [&](MachineId_t machine_id) {
+        Score_t score = Score(now, demand, machine_id);
+        if (best == MachineId_t(-1) || Better(score, best_score)) {
+            best = machine_id;
+            best_score = score;
+        }
+    });
+    if (best != MachineId_t(-1) && best_score.tier == TIER_LATE_WAKING &&
+        index->UpCores(demand.cpu, false) + index->UpCores(demand.cpu, true) >
+            power->WakingCores(demand.cpu, false) + power->WakingCores(demand.cpu, true)) {
+        return MachineId_t(-1);
+    }
+    return best;
+}
@@ -0,0 +1,69 @@
+//
+//  Placement.hpp
+//  CloudSim
+//
+
+#ifndef Placement_hpp
+#define Placement_hpp
+
+#include <vector>
+
+#include "CapacityIndex.hpp"
+#include "PowerManager.hpp"
+
+// What the placement model needs to know about a task
+typedef struct {
+    uint64_t instructions;
+    Time_t target_completion;
+    SLAType_t sla;
+    bool gpu;                               // True if the task benefits from a GPU
+    unsigned memory;                        // Memory the task needs on the machine, VM overhead included
+    CPUType_t cpu;
+} Demand_t;
+
+// Cost of a candidate machine, lower is better. Tiers go first: a machine where the task
+// makes its target with a core of its own and the GPU flavor it asks for, then one of the
+// other flavor, then one it would have to share cores on, then one where it misses its
+// target, and last one where it misses its target and has to wait for the machine to wake up.
+// Within the first two tiers the machine costing the least marginal energy wins. On
+// saturated machines the task queues behind the tasks beyond the number of cores, there the
+// machine where it is done soonest wins, and among machines where it is late the one where
+// it is least late, which spreads the load rather than piling it on the cheapest machine.
+typedef struct {
+    unsigned tier;
+    double cost;                            // Watt-microseconds, or microseconds in the last three tiers
+} Score_t;
+
+// Class-aware placement. The machine classes differ by an order of magnitude in MIPS and in
+// power, so the model keeps a table per class with, for each P-state, the time an instruction
+// takes and the energy it costs, both on a core of its own and with the core's share of the
+// machine's S0 power. A candidate is scored from its class table, its share of the cores and
+// how long it takes to wake (see PowerManager::WakeDelay): the P-state DVFS would settle on
+// is the cheapest per instruction that still makes the target, and the marginal energy is
+// what the machine draws for the task on top of what it draws anyway, waking it included.
+// On a saturated machine the expected queueing delay is the run time of the task stretched
+// by the tasks beyond the number of cores, over the cores.
+// Scoring a candidate is constant time; the candidates are the best fits in every bucket of
+// the capacity index.
+class PlacementModel {
+public:
+    PlacementModel()            {}
+    void Init(const CapacityIndex & index, const PowerManager & power);
+    MachineId_t Find(Time_t now, const Demand_t & demand) const;
+    Score_t Score(Time_t now, const Demand_t & demand, MachineId_t machine_id) const;
+private:
+    typedef struct {
+        bool valid;                         // False if the class lacks a power or MIPS table
+        double mips[P_STATES];              // Instructions per microsecond
+        double core_energy[P_STATES];       // Watts a busy core draws above an idle one, per MIPS
+        double machine_energy[P_STATES];    // The same with the core's share of the S0 power
+        double s_power[S_STATES];           // Watts the machine draws in each S-state
+        CPUPerformance_t order[P_STATES];   // P-states from the least energy per instruction up
+    } ClassCost_t;
+
+    const CapacityIndex * index;
+    const PowerManager * power;
+    vector<ClassCost_t> classes;
+};
+
+#endif /* Placement_hpp */
@@ -0,0 +1,34 @@
+//
+//  Policies.cpp
+//  CloudSim
+//
+
+#include "Policies.hpp"
+
+void RoundRobinPolicy::Init() {
+    Scheduler::Init();
+    machines_per_cpu = vector<vector<MachineId_t>>(CPU_TYPES);
+    next = vector<unsigned>(CPU_TYPES, 0);
+    for (MachineId_t machine_id : machines) {
+        machines_per_cpu[index.Get(machine_id).cpu].push_back(machine_id);
+    }
+}
+
+/**
+ * Take the next machine of the task's CPU type that has room for it.
+ * @returns the machine and the VM to use as Scheduler::FindMachine does.
+ * If no machine has room, falls back to Scheduler::FindMachine.
+ */
+pair<MachineId_t, VMId_t> RoundRobinPolicy::FindMachine(const TaskInfo_t & info, bool prefer_gpu, unsigned int task_mem, CPUType_t cpu, VMType_t vm_type) {
+    const vector<MachineId_t> & candidates = machines_per_cpu[cpu];
+    for (unsigned i = 0; i < candidates.size(); i++) {
+        MachineId_t machine_id = candidates[next[cpu]];
+        next[cpu] = (next[cpu] + 1) % candidates.size();
+
+        const MachineSlot_t & slot = index.Get(machine_id);
+        if (slot.listed && slot.memory_used + task_mem <= slot.memory_size) {
+            return {machine_id, FindVM(machine_id, vm_type, cpu)};
+        }
+    }
+    return Scheduler::FindMachine(info, prefer_gpu, task_mem, cpu, vm_type);
+}
@@ -0,0 +1,34 @@
+//
+//  Policies.hpp
+//  CloudSim
+//
+
+#ifndef Policies_hpp
+#define Policies_hpp
+
+#include "Policy.hpp"
+
+// Best fit through the capacity index, idle machines are powered off
+class GreedyPolicy : public Policy<GreedyPolicy> {
+};
+
+// Spreads tasks over the machines of the required CPU type in turn
+class RoundRobinPolicy : public Policy<RoundRobinPolicy> {
+public:
+    void Init();
+    pair<MachineId_t, VMId_t> FindMachine(const TaskInfo_t & info, bool prefer_gpu, unsigned int task_mem, CPUType_t cpu, VMType_t vm_type);
+private:
+    vector<vector<MachineId_t>> machines_per_cpu;
+    vector<unsigned> next;
+};
+
+// The policy is chosen with "make POLICY=<name>"
+#if defined(POLICY_GREEDY)
+typedef GreedyPolicy SelectedPolicy;
+#elif defined(POLICY_ROUND_ROBIN)
+typedef RoundRobinPolicy SelectedPolicy;
+#else
+#error "Unknown scheduling policy, build with POLICY=GREEDY or POLICY=ROUND_ROBIN"
+#endif
+
+#endif /* Policies_hpp */
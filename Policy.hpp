@@ -0,0 +1,138 @@
+//
+//  Policy.hpp
+//  CloudSim
+//
+
+#ifndef Policy_hpp
+#define Policy_hpp
+
+#include "Logging.h"
+#include "Profile.h"
+#include "Scheduler.hpp"
+
+// Base of every scheduling policy. A policy derives from Policy<itself> and hides the
+// Scheduler callbacks or hooks it wants to change (FindMachine, FindVM, TaskPriority,
+// PeriodicCheck, TaskComplete, HandleWarning, MigrationComplete, HandleStateChange, ...).
+// The policy is picked at compile time (see Policies.hpp), so every call resolves statically.
+// The scheduler's own paths reach FindVM and TaskPriority through the hooks handed in below.
+template <class Derived>
+class Policy : public Scheduler {
+public:
+    Policy() {
+        find_vm = [](Scheduler & scheduler, MachineId_t machine_id, VMType_t vm_type, CPUType_t cpu) {
+            return static_cast<Derived &>(scheduler).FindVM(machine_id, vm_type, cpu);
+        };
+        task_priority = [](Scheduler & scheduler, TaskId_t task_id) {
+            return static_cast<Derived &>(scheduler).TaskPriority(task_id);
+        };
+    }
+
+    void NewTask(Time_t now, TaskId_t task_id) {
+        TaskInfo_t info = GetTaskInfo(task_id);
+        pair<MachineId_t, VMId_t> ret = Locate(info);
+        if (ret.first == MachineId_t(-1)) {
+            Queue(info);
+            return;
+        }
+        PlaceTask(info, ret.first, ret.second, derived().TaskPriority(task_id));
+    }
+
+    // Places tasks that arrived together. Larger tasks go first (first fit decreasing) and a
+    // task keeps filling the machine picked for the previous task needing the same kind of VM
+    // while it has room and a spare core, so the batch shares VMs. A machine still waking up is
+    // scored again for each task, the wake-up may make it late.
+    void NewTasks(Time_t now, const vector<TaskId_t> & task_ids) {
+        batch.clear();
+        for (TaskId_t task_id : task_ids) {
+            batch.push_back(GetTaskInfo(task_id));
+        }
+        stable_sort(batch.begin(), batch.end(), [](const TaskInfo_t & lhs, const TaskInfo_t & rhs) {
+            return lhs.required_memory > rhs.required_memory;
+        });
+
+        MachineId_t last[CPU_TYPES * VM_TYPES * 2];
+        fill(last, last + CPU_TYPES * VM_TYPES * 2, MachineId_t(-1));
+        for (const TaskInfo_t & info : batch) {
+            TaskId_t task_id = info.task_id;
+            bool gpu = info.gpu_capable;
+            unsigned int task_mem = info.required_memory + VM_MEMORY_OVERHEAD;
+            VMType_t vm_type = info.required_vm;
+            CPUType_t cpu = info.required_cpu;
+            MachineId_t & previous = last[(cpu * VM_TYPES + vm_type) * 2 + gpu];
+
+            pair<MachineId_t, VMId_t> ret;
+            if (previous != MachineId_t(-1) && HasRoom(previous, task_mem) && power.WakeDelay(now, previous) == 0) {
+                ret = {previous, derived().FindVM(previous, vm_type, cpu)};
+            } else {
+                SIM_LOG(3, "Attempting to look for machine to place new task in with task id ", task_id);
+                SIM_PROFILE_SCOPE(PROFILE_FIND_MACHINE);
+                ret = derived().FindMachine(info, gpu, task_mem, cpu, vm_type);
+            }
+            if (ret.first == MachineId_t(-1)) {
+                Queue(info);
+                continue;
+            }
+            previous = ret.first;
+            PlaceTask(info, ret.first, ret.second, derived().TaskPriority(task_id));
+        }
+    }
+
+    // Machines come back to the capacity index when they reach S5 or get back under their
+    // high-water mark, the queued tasks are retried then
+    void PeriodicCheck(Time_t now) {
+        Scheduler::PeriodicCheck(now);
+        PlaceQueued();
+    }
+
+    void HandleStateChange(Time_t time, MachineId_t machine_id) {
+        Scheduler::HandleStateChange(time, machine_id);
+        PlaceQueued();
+    }
+protected:
+    Derived & derived()         { return static_cast<Derived &>(*this); }
+
+    pair<MachineId_t, VMId_t> Locate(const TaskInfo_t & info) {
+        unsigned int task_mem = info.required_memory + VM_MEMORY_OVERHEAD;
+
+        SIM_LOG(3, "Attempting to look for machine to place new task in with task id ", info.task_id);
+        SIM_PROFILE_SCOPE(PROFILE_FIND_MACHINE);
+        return derived().FindMachine(info, info.gpu_capable, task_mem, info.required_cpu, info.required_vm);
+    }
+
+    // Every machine of the task's CPU type is unlisted, on its way to S5 or fenced. Rather
+    // than drop the task, it waits for one to be listed again.
+    void Queue(const TaskInfo_t & info) {
+        SIM_LOG(3, "Unable to find machine for task with id ", info.task_id, ", queueing it");
+        CPUType_t cpu = info.required_cpu;
+        unplaced[cpu].push_back(info.task_id);
+        unplaced_demand[unsigned(cpu) * 2 + info.gpu_capable]++;
+        queued++;
+    }
+
+    // Places the queued tasks of each CPU type in arrival order, up to the first that still
+    // finds no machine
+    void PlaceQueued() {
+        for (unsigned cpu = 0; cpu < CPU_TYPES; cpu++) {
+            deque<TaskId_t> & queue = unplaced[cpu];
+            while (!queue.empty()) {
+                TaskInfo_t info = GetTaskInfo(queue.front());
+                pair<MachineId_t, VMId_t> ret = Locate(info);
+                if (ret.first == MachineId_t(-1)) {
+                    break;
+                }
+                queue.pop_front();
+                unplaced_demand[cpu * 2 + info.gpu_capable]--;
+                PlaceTask(info, ret.first, ret.second, derived().TaskPriority(info.task_id));
+            }
+        }
+    }
+
+    bool HasRoom(MachineId_t machine_id, unsigned task_mem) const {
+        const MachineSlot_t & slot = index.Get(machine_id);
+        return slot.listed && slot.memory_used + task_mem <= slot.memory_size && slot.active_tasks < slot.num_cpus;
+    }
+private:
+    vector<TaskInfo_t> batch;
+};
+
+#endif /* Policy_hpp */
@@ -0,0 +1,221 @@
+//
+//  PowerManager.cpp
+//  CloudSim
+//
+
+#include <cmath>
+
+#include "PowerManager.hpp"
+
+// Weight of the newest sample in the moving averages
+#define RATE_ALPHA      0.25
+#define RUN_TIME_ALPHA  0.1
+#define LATENCY_ALPHA   0.5
+
+// Seconds the cluster takes tasks before a group that got none is taken to need no machine up
+#define QUIET_SECONDS   1.0
+
+// Seconds to wake a machine from each S-state until a wake-up from it has been seen, as the
+// simulator took on the sample workloads
+static const double WAKE_SECONDS[S_STATES] = {0.0, 0.06, 0.5, 2.0, 6.0, 30.0, 300.0};
+
+static double Seconds(Time_t time) {
+    return double(time) / 1000000;
+}
+
+static bool Pooled(MachineState_t s_state) {
+    return s_state != S0 && s_state != S5;
+}
+
+void PowerManager::Init(const CapacityIndex & index) {
+    this->index = &index;
+    groups = vector<Group_t>(CPU_TYPES * 2, {0, 0, 0.0, 0.0, 0.0, 0});
+    machines.resize(index.Size());
+    for (unsigned i = 0; i < index.Size(); i++) {
+        machines[i] = {index.Get(MachineId_t(i)).s_state, S0, 0};
+    }
+    last_tick = 0;
+    interval = 0;
+    first_arrival = 0;
+    wake_aheads = 0;
+    fill(wakes, wakes + S_STATES, 0);
+    fill(wake_time, wake_time + S_STATES, 0.0);
+    pool_energy = 0.0;
+    pool_cost = 0.0;
+    fill(starts, starts + START_KINDS, 0);
+    fill(violations, violations + START_KINDS, 0);
+}
+
+// Folds the arrivals since the last tick into the rate of every group
+void PowerManager::Tick(Time_t now) {
+    interval = now - last_tick;
+    last_tick = now;
+    if (interval == 0) {
+        return;
+    }
+    for (Group_t & group : groups) {
+        if (first_arrival == 0 && group.arrivals > 0) {
+            first_arrival = now;
+        }
+        double rate = group.arrivals / Seconds(interval);
+        group.rate = RATE_ALPHA * rate + (1 - RATE_ALPHA) * group.rate;
+        group.arrivals = 0;
+    }
+}
+
+// True once the forecast of a group has something to go by: a task of the group completed,
+// or the group got no task during the first QUIET_SECONDS of arrivals
+bool PowerManager::Calibrated(Time_t now, CPUType_t cpu, bool gpus) const {
+    const Group_t & group = groups[GroupOf(cpu, gpus)];
+    if (group.placed > 0) {
+        return group.run_time > 0.0;
+    }
+    return first_arrival != 0 && Seconds(now - first_arrival) >= QUIET_SECONDS;
+}
+
+/**
+ * The cores a group should have up: the ones in use plus the arrivals expected while a
+ * machine comes up from S5. Arrivals beyond a task's run time are covered by completions.
+ * A group always keeps at least one machine within reach, a task arriving while every
+ * machine is on its way to S5 would find nowhere to go.
+ * @param busy_cores the tasks on the group's machines, listed or not, and those waiting for one
+ * @returns the number of cores to keep up or in the warm pool
+ */
+unsigned PowerManager::TargetCores(CPUType_t cpu, bool gpus, unsigned busy_cores) const {
+    const Group_t & group = groups[GroupOf(cpu, gpus)];
+    // Until a wake-up from S5 has been seen, assume it takes longer than any task
+    double horizon = group.wake_latency == 0.0 ? group.run_time : min(group.wake_latency, group.run_time);
+    return max(busy_cores + unsigned(ceil(group.rate * horizon)), 1u);
+}
+
+/**
+ * The state an idle machine kept in the warm pool waits in. The cores expected to be needed
+ * before a machine could come up from S3 stay in S0i1, which wakes almost at once, the rest
+ * go down to S3.
+ * @param pooled_cores the cores of the group already kept in the pool during this tick
+ */
+MachineState_t PowerManager::PoolState(CPUType_t cpu, bool gpus, unsigned pooled_cores) const {
+    const Group_t & group = groups[GroupOf(cpu, gpus)];
+    double horizon = max(Seconds(interval), wakes[S3] > 0 ? wake_time[S3] / wakes[S3] : 0.0);
+    return pooled_cores < group.rate * horizon ? S0i1 : S3;
+}
+
+StartKind_t PowerManager::StartKind(MachineId_t machine_id) const {
+    MachineState_t from = machines[machine_id].waking_from;
+    if (from == S0) {
+        return HOT_START;
+    }
+    return from == S5 ? COLD_START : WARM_START;
+}
+
+void PowerManager::TaskPlaced(CPUType_t cpu, bool gpus) {
+    Group_t & group = groups[GroupOf(cpu, gpus)];
+    group.arrivals++;
+    group.placed++;
+}
+
+void PowerManager::TaskCompleted(CPUType_t cpu, bool gpus, Time_t run_time, StartKind_t start, bool violated) {
+    Group_t & group = groups[GroupOf(cpu, gpus)];
+    group.run_time = group.run_time == 0.0 ? Seconds(run_time)
+                                           : RUN_TIME_ALPHA * Seconds(run_time) + (1 - RUN_TIME_ALPHA) * group.run_time;
+    starts[start]++;
+    if (violated) {
+        violations[start]++;
+    }
+}
+
+/**
+ * @returns the seconds a wake-up from the state takes, averaged over the ones seen so far.
+ */
+double PowerManager::WakeLatency(MachineState_t s_state) const {
+    return wakes[s_state] > 0 ? wake_time[s_state] / wakes[s_state] : WAKE_SECONDS[s_state];
+}
+
+/**
+ * How long until a machine could run a task placed on it now.
+ * @returns 0 for a machine that is up, what is left of the wake-up for one on its way up (at
+ * least 1 once it takes longer than the wake-ups seen so far) and the whole wake-up for one
+ * asleep or heading to sleep.
+ */
+Time_t PowerManager::WakeDelay(Time_t now, MachineId_t machine_id) const {
+    const MachinePower_t & machine = machines[machine_id];
+    if (machine.s_state != S0) {
+        return Time_t(WakeLatency(machine.s_state) * 1000000);
+    }
+    if (machine.waking_from == S0) {
+        return 0;
+    }
+    Time_t latency = Time_t(WakeLatency(machine.waking_from) * 1000000);
+    return now - machine.since < latency ? latency - (now - machine.since) : 1;
+}
+
+/**
+ * Record that the scheduler asked a machine to change state.
+ * @param s_state the state requested
+ * @param ahead true if the machine is woken ahead of demand rather than for a task
+ */
+void PowerManager::StateRequested(Time_t now, MachineId_t machine_id, MachineState_t s_state, bool ahead) {
+    Accrue(now, machine_id);
+    MachinePower_t & machine = machines[machine_id];
+    if (s_state == S0 && machine.s_state != S0) {
+        machine.waking_from = machine.s_state;
+        wake_aheads += ahead;
+        const MachineSlot_t & slot = index->Get(machine_id);
+        groups[GroupOf(slot.cpu, slot.gpus)].waking_cores += slot.num_cpus;
+    }
+    machine.s_state = s_state;
+    machine.since = now;
+}
+
+void PowerManager::StateChanged(Time_t now, MachineId_t machine_id) {
+    MachinePower_t & machine = machines[machine_id];
+    if (machine.waking_from == S0) {
+        return;
+    }
+    double latency = Seconds(now - machine.since);
+    wakes[machine.waking_from]++;
+    wake_time[machine.waking_from] += latency;
+    const MachineSlot_t & slot = index->Get(machine_id);
+    Group_t & group = groups[GroupOf(slot.cpu, slot.gpus)];
+    group.waking_cores -= slot.num_cpus;
+    if (machine.waking_from == S5) {
+        group.wake_latency = group.wake_latency == 0.0 ? latency
+                                                       : LATENCY_ALPHA * latency + (1 - LATENCY_ALPHA) * group.wake_latency;
+    }
+    machine.waking_from = S0;
+    machine.since = now;
+}
+
+// Charges the time a machine spent in the warm pool at the power of its state
+void PowerManager::Accrue(Time_t now, MachineId_t machine_id) {
+    MachinePower_t & machine = machines[machine_id];
+    const vector<unsigned> & power = index->GetClass(machine_id).s_states;
+    if (!Pooled(machine.s_state) || power.size() != S_STATES) {
+        return;
+    }
+    double elapsed = double(now - machine.since);
+    pool_energy += power[machine.s_state] * elapsed;
+    pool_cost += (double(power[machine.s_state]) - double(power[S5])) * elapsed;
+    machine.since = now;
+}
+
+void PowerManager::Report(Time_t now) {
+    for (unsigned i = 0; i < machines.size(); i++) {
+        Accrue(now, MachineId_t(i));
+    }
+    static const char * names[S_STATES] = {"S0", "S0i1", "S1", "S2", "S3", "S4", "S5"};
+    static const char * kinds[START_KINDS] = {"hot", "warm", "cold"};
+
+    cout << "Power manager report" << endl;
+    cout << "Wake-ups ahead of demand: " << wake_aheads << endl;
+    for (unsigned s = S0i1; s < S_STATES; s++) {
+        if (wakes[s] > 0) {
+            cout << "Wake-ups from " << names[s] << ": " << wakes[s] << ", " << wake_time[s] / wakes[s] << " seconds on average" << endl;
+        }
+    }
+    for (unsigned k = 0; k < START_KINDS; k++) {
+        cout << "Tasks started " << kinds[k] << ": " << starts[k] << ", " << violations[k] << " SLA violations" << endl;
+    }
+    // Watt-microseconds to kilowatt-hours
+    cout << "Warm pool energy " << pool_energy / 3.6e12 << "KW-Hour, " << pool_cost / 3.6e12 << "KW-Hour above S5" << endl;
+}
@@ -0,0 +1,82 @@
+//
+//  PowerManager.hpp
+//  CloudSim
+//
+
+#ifndef PowerManager_hpp
+#define PowerManager_hpp
+
+#include <vector>
+
+#include "CapacityIndex.hpp"
+
+typedef enum {
+    HOT_START,                              // Placed on a machine that was up
+    WARM_START,                             // Placed on a machine woken from an intermediate state
+    COLD_START                              // Placed on a machine woken from S5
+} StartKind_t;
+#define START_KINDS 3
+
+// Demand forecast and warm pool sizing for the machines of each CPU type and GPU flavor.
+// Arrival rates, task run times and wake-up latencies are tracked as moving averages, from
+// which the manager tells how many cores a group should keep up and which intermediate state
+// an idle machine should wait in. The forecast of a group that has tasks but has not seen
+// one complete knows neither their run time nor much of their arrival rate, and that of a
+// group without tasks only tells it needs no machine once the cluster has been taking tasks
+// for a while, so the scheduler leaves idle machines of such a group up.
+// It also keeps the books on its decisions: the energy the warm pool drew and how tasks that
+// started hot, warm or cold fared against their SLA.
+class PowerManager {
+public:
+    PowerManager()              {}
+    void Init(const CapacityIndex & index);
+    void Tick(Time_t now);
+    unsigned TargetCores(CPUType_t cpu, bool gpus, unsigned busy_cores) const;
+    MachineState_t PoolState(CPUType_t cpu, bool gpus, unsigned pooled_cores) const;
+    StartKind_t StartKind(MachineId_t machine_id) const;
+    unsigned WakingCores(CPUType_t cpu, bool gpus) const { return groups[GroupOf(cpu, gpus)].waking_cores; }
+    bool Calibrated(Time_t now, CPUType_t cpu, bool gpus) const;
+    double WakeLatency(MachineState_t s_state) const;
+    Time_t WakeDelay(Time_t now, MachineId_t machine_id) const;
+
+    void TaskPlaced(CPUType_t cpu, bool gpus);
+    void TaskCompleted(CPUType_t cpu, bool gpus, Time_t run_time, StartKind_t start, bool violated);
+    void StateRequested(Time_t now, MachineId_t machine_id, MachineState_t s_state, bool ahead);
+    void StateChanged(Time_t now, MachineId_t machine_id);
+    void Report(Time_t now);
+private:
+    typedef struct {
+        unsigned arrivals;                  // Arrivals since the last tick
+        unsigned placed;                    // Arrivals since the start
+        double rate;                        // Arrivals per second
+        double run_time;                    // Seconds a task runs
+        double wake_latency;                // Seconds to bring a machine up from S5, 0 until seen
+        unsigned waking_cores;              // Cores of the machines on their way up
+    } Group_t;
+
+    typedef struct {
+        MachineState_t s_state;             // The state the machine is in, or is heading to
+        MachineState_t waking_from;         // The state a wake-up started from, S0 if not waking
+        Time_t since;                       // When the machine entered s_state or started waking
+    } MachinePower_t;
+
+    static unsigned GroupOf(CPUType_t cpu, bool gpus) { return unsigned(cpu) * 2 + gpus; }
+    void Accrue(Time_t now, MachineId_t machine_id);
+
+    const CapacityIndex * index;
+    vector<Group_t> groups;
+    vector<MachinePower_t> machines;
+    Time_t last_tick;
+    Time_t interval;                        // Time between the last two ticks
+    Time_t first_arrival;                   // Tick that saw the first arrival, 0 before
+
+    unsigned wake_aheads;
+    unsigned wakes[S_STATES];               // Completed wake-ups by the state they started from
+    double wake_time[S_STATES];             // Their total latency in seconds
+    double pool_energy;                     // Watt-microseconds drawn in intermediate states
+    double pool_cost;                       // The part of it above what S5 would have drawn
+    unsigned starts[START_KINDS];
+    unsigned violations[START_KINDS];
+};
+
+#endif /* PowerManager_hpp */
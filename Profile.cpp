@@ -0,0 +1,269 @@
+//
+//  Profile.cpp
+//  CloudSim
+//
+//  The interface functions live in the prebuilt Machine.o, VM.o and Task.o and the event queue
+//  in the prebuilt Simulator.o, so their calls are counted by wrapping them at link time with
+//  --wrap (see the Makefile).
+//
+
+#ifdef SIM_PROFILE
+
+#include <cstdlib>
+#include <fstream>
+#include <sys/resource.h>
+
+#include "Profile.h"
+
+// Bucket b counts the calls that took [2^(b-1), 2^b) nanoseconds, bucket 0 the ones under 1
+#define HISTOGRAM_BUCKETS 64
+
+typedef struct {
+    uint64_t calls;
+    uint64_t total;                         // Nanoseconds
+    uint64_t max;
+    uint64_t buckets[HISTOGRAM_BUCKETS];
+} Histogram_t;
+
+static const char * callback_names[PROFILE_CALLBACKS] = {
+    "NewTask", "NewTasks", "FindMachine", "TaskComplete", "PeriodicCheck",
+    "HandleStateChange", "MigrationComplete", "SLAWarning", "MemoryWarning"
+};
+static const char * call_names[INTERFACE_CALLS] = {
+    "Machine_GetInfo", "Machine_SetState", "VM_GetInfo", "VM_Create", "VM_AddTask", "VM_Migrate", "GetTaskInfo"
+};
+static const char * event_names[EVENT_KINDS] = {
+    "task arrival", "task completion", "migration", "timer"
+};
+
+static Histogram_t histograms[PROFILE_CALLBACKS];
+static uint64_t interface_calls[INTERFACE_CALLS];
+static uint64_t scheduled_events[EVENT_KINDS];
+static chrono::steady_clock::time_point started;
+static ofstream trace;                      // SIM_EVENT_TRACE
+static bool trace_checked = false;
+
+void ProfileInit() {
+    started = chrono::steady_clock::now();
+}
+
+void ProfileRecord(ProfiledCallback_t callback, uint64_t nanoseconds) {
+    Histogram_t & histogram = histograms[callback];
+    histogram.calls++;
+    histogram.total += nanoseconds;
+    histogram.max = max(histogram.max, nanoseconds);
+    unsigned bucket = nanoseconds == 0 ? 0 : 64 - __builtin_clzll(nanoseconds);
+    histogram.buckets[min(bucket, unsigned(HISTOGRAM_BUCKETS - 1))]++;
+}
+
+// The arrivals are scheduled before InitScheduler(), so the trace is opened by the first event
+void ProfileEvent(ScheduledEvent_t event, Time_t time) {
+    scheduled_events[event]++;
+    if (!trace_checked) {
+        trace_checked = true;
+        const char * path = getenv("SIM_EVENT_TRACE");
+        if (path != nullptr) {
+            trace.open(path, ios::binary | ios::trunc);
+            if (!trace) {
+                ThrowException("ProfileEvent(): Unable to open event trace ", string(path));
+            }
+        }
+    }
+    if (trace.is_open()) {
+        uint64_t record[2] = {Now(), time};
+        trace.write(reinterpret_cast<const char *>(record), sizeof(record));
+    }
+}
+
+// Upper bound of the bucket holding the given fraction of the calls, in nanoseconds
+static uint64_t Percentile(const Histogram_t & histogram, double fraction) {
+    uint64_t seen = 0;
+    for (unsigned b = 0; b < HISTOGRAM_BUCKETS; b++) {
+        seen += histogram.buckets[b];
+        if (seen >= fraction * histogram.calls) {
+            return uint64_t(1) << b;
+        }
+    }
+    return histogram.max;
+}
+
+// FindMachine runs inside NewTask and NewTasks, it is not counted twice
+static uint64_t SchedulerTime() {
+    uint64_t total = 0;
+    for (unsigned c = 0; c < PROFILE_CALLBACKS; c++) {
+        if (c != PROFILE_FIND_MACHINE) {
+            total += histograms[c].total;
+        }
+    }
+    return total;
+}
+
+// The events the simulator's queue was fed
+static uint64_t Events() {
+    uint64_t events = 0;
+    for (unsigned e = 0; e < EVENT_KINDS; e++) {
+        events += scheduled_events[e];
+    }
+    return events;
+}
+
+// The callbacks the simulator made into the scheduler
+static uint64_t Callbacks() {
+    uint64_t callbacks = 0;
+    for (unsigned c = 0; c < PROFILE_CALLBACKS; c++) {
+        if (c != PROFILE_FIND_MACHINE) {
+            callbacks += histograms[c].calls;
+        }
+    }
+    return callbacks;
+}
+
+// Kilobytes on Linux
+static long PeakRSS() {
+    struct rusage usage;
+    return getrusage(RUSAGE_SELF, &usage) == 0 ? usage.ru_maxrss : 0;
+}
+
+static void WriteJSON(const char * path, uint64_t wall) {
+    ofstream out(path);
+    if (!out) {
+        ThrowException("ProfileReport(): Unable to open profile file ", string(path));
+    }
+    out << "{\n  \"wall_ns\": " << wall << ",\n  \"scheduler_ns\": " << SchedulerTime() << ",\n  \"events\": " << Events()
+        << ",\n  \"scheduler_callbacks\": " << Callbacks() << ",\n  \"peak_rss_kb\": " << PeakRSS() << ",\n  \"events_by_kind\": {";
+    for (unsigned e = 0; e < EVENT_KINDS; e++) {
+        out << (e == 0 ? "\n" : ",\n") << "    \"" << event_names[e] << "\": " << scheduled_events[e];
+    }
+    out << "\n  },\n  \"callbacks\": {";
+    for (unsigned c = 0; c < PROFILE_CALLBACKS; c++) {
+        const Histogram_t & histogram = histograms[c];
+        unsigned used = HISTOGRAM_BUCKETS;
+        while (used > 0 && histogram.buckets[used - 1] == 0) {
+            used--;
+        }
+        out << (c == 0 ? "\n" : ",\n") << "    \"" << callback_names[c] << "\": {\"calls\": " << histogram.calls
+            << ", \"total_ns\": " << histogram.total << ", \"max_ns\": " << histogram.max << ", \"log2_ns_buckets\": [";
+        for (unsigned b = 0; b < used; b++) {
+            out << (b == 0 ? "" : ", ") << histogram.buckets[b];
+        }
+        out << "]}";
+    }
+    out << "\n  },\n  \"interface_calls\": {";
+    for (unsigned i = 0; i < INTERFACE_CALLS; i++) {
+        out << (i == 0 ? "\n" : ",\n") << "    \"" << call_names[i] << "\": " << interface_calls[i];
+    }
+    out << "\n  }\n}\n";
+}
+
+void ProfileReport() {
+    uint64_t wall = uint64_t(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - started).count());
+    uint64_t scheduler = SchedulerTime();
+    cout << "Scheduler profile: " << scheduler / 1e6 << " ms of " << wall / 1e6 << " ms wall time in the scheduler ("
+         << (wall > 0 ? 100.0 * scheduler / wall : 0.0) << "%)" << endl;
+    for (unsigned c = 0; c < PROFILE_CALLBACKS; c++) {
+        const Histogram_t & histogram = histograms[c];
+        if (histogram.calls == 0) {
+            continue;
+        }
+        cout << "  " << callback_names[c] << ": " << histogram.calls << " calls, " << histogram.total / 1e6 << " ms, mean "
+             << histogram.total / 1e3 / histogram.calls << " us, p50 < " << Percentile(histogram, 0.5) / 1e3 << " us, p99 < "
+             << Percentile(histogram, 0.99) / 1e3 << " us, max " << histogram.max / 1e3 << " us" << endl;
+    }
+    cout << "Events: " << Events() << ", " << (wall > 0 ? Events() * 1e9 / wall : 0.0) << " per second, peak RSS " << PeakRSS() << " KB" << endl;
+    cout << "Events scheduled:";
+    for (unsigned e = 0; e < EVENT_KINDS; e++) {
+        cout << (e == 0 ? " " : ", ") << event_names[e] << " " << scheduled_events[e];
+    }
+    cout << "; scheduler callbacks " << Callbacks() << endl;
+    cout << "Interface calls:";
+    for (unsigned i = 0; i < INTERFACE_CALLS; i++) {
+        cout << (i == 0 ? " " : ", ") << call_names[i] << " " << interface_calls[i];
+    }
+    cout << endl;
+
+    const char * path = getenv("SIM_PROFILE_JSON");
+    if (path != nullptr) {
+        WriteJSON(path, wall);
+    }
+    if (trace.is_open()) {
+        trace.close();
+    }
+}
+
+// Link-time wrappers counting the interface calls
+
+extern MachineInfo_t RealMachineGetInfo(MachineId_t machine_id) asm("__real__Z15Machine_GetInfoj");
+extern void RealMachineSetState(MachineId_t machine_id, MachineState_t s_state) asm("__real__Z16Machine_SetStatej14MachineState_t");
+extern VMInfo_t RealVMGetInfo(VMId_t vm_id) asm("__real__Z10VM_GetInfoj");
+extern VMId_t RealVMCreate(VMType_t vm_type, CPUType_t cpu) asm("__real__Z9VM_Create8VMType_t9CPUType_t");
+extern void RealVMAddTask(VMId_t vm_id, TaskId_t task_id, Priority_t priority) asm("__real__Z10VM_AddTaskjj10Priority_t");
+extern void RealVMMigrate(VMId_t vm_id, MachineId_t machine_id) asm("__real__Z10VM_Migratejj");
+extern TaskInfo_t RealGetTaskInfo(TaskId_t task_id) asm("__real__Z11GetTaskInfoj");
+
+MachineInfo_t WrapMachineGetInfo(MachineId_t machine_id) asm("__wrap__Z15Machine_GetInfoj");
+void WrapMachineSetState(MachineId_t machine_id, MachineState_t s_state) asm("__wrap__Z16Machine_SetStatej14MachineState_t");
+VMInfo_t WrapVMGetInfo(VMId_t vm_id) asm("__wrap__Z10VM_GetInfoj");
+VMId_t WrapVMCreate(VMType_t vm_type, CPUType_t cpu) asm("__wrap__Z9VM_Create8VMType_t9CPUType_t");
+void WrapVMAddTask(VMId_t vm_id, TaskId_t task_id, Priority_t priority) asm("__wrap__Z10VM_AddTaskjj10Priority_t");
+void WrapVMMigrate(VMId_t vm_id, MachineId_t machine_id) asm("__wrap__Z10VM_Migratejj");
+TaskInfo_t WrapGetTaskInfo(TaskId_t task_id) asm("__wrap__Z11GetTaskInfoj");
+
+extern void RealScheduleTaskCompletion(Time_t time, MachineId_t machine_id, unsigned core_id) asm("__real__Z22ScheduleTaskCompletionmjj");
+extern void RealScheduleMigrationCompletion(Time_t time, VMId_t vm_id) asm("__real__Z27ScheduleMigrationCompletionmj");
+extern void RealScheduleTimer(Time_t time) asm("__real__Z13ScheduleTimerm");
+
+void WrapScheduleTaskCompletion(Time_t time, MachineId_t machine_id, unsigned core_id) asm("__wrap__Z22ScheduleTaskCompletionmjj");
+void WrapScheduleMigrationCompletion(Time_t time, VMId_t vm_id) asm("__wrap__Z27ScheduleMigrationCompletionmj");
+void WrapScheduleTimer(Time_t time) asm("__wrap__Z13ScheduleTimerm");
+
+MachineInfo_t WrapMachineGetInfo(MachineId_t machine_id) {
+    interface_calls[CALL_MACHINE_GET_INFO]++;
+    return RealMachineGetInfo(machine_id);
+}
+
+void WrapMachineSetState(MachineId_t machine_id, MachineState_t s_state) {
+    interface_calls[CALL_MACHINE_SET_STATE]++;
+    RealMachineSetState(machine_id, s_state);
+}
+
+VMInfo_t WrapVMGetInfo(VMId_t vm_id) {
+    interface_calls[CALL_VM_GET_INFO]++;
+    return RealVMGetInfo(vm_id);
+}
+
+VMId_t WrapVMCreate(VMType_t vm_type, CPUType_t cpu) {
+    interface_calls[CALL_VM_CREATE]++;
+    return RealVMCreate(vm_type, cpu);
+}
+
+void WrapVMAddTask(VMId_t vm_id, TaskId_t task_id, Priority_t priority) {
+    interface_calls[CALL_VM_ADD_TASK]++;
+    RealVMAddTask(vm_id, task_id, priority);
+}
+
+void WrapVMMigrate(VMId_t vm_id, MachineId_t machine_id) {
+    interface_calls[CALL_VM_MIGRATE]++;
+    RealVMMigrate(vm_id, machine_id);
+}
+
+TaskInfo_t WrapGetTaskInfo(TaskId_t task_id) {
+    interface_calls[CALL_GET_TASK_INFO]++;
+    return RealGetTaskInfo(task_id);
+}
+
+void WrapScheduleTaskCompletion(Time_t time, MachineId_t machine_id, unsigned core_id) {
+    ProfileEvent(EVENT_TASK_COMPLETION, time);
+    RealScheduleTaskCompletion(time, machine_id, core_id);
+}
+
+void WrapScheduleMigrationCompletion(Time_t time, VMId_t vm_id) {
+    ProfileEvent(EVENT_MIGRATION, time);
+    RealScheduleMigrationCompletion(time, vm_id);
+}
+
+void WrapScheduleTimer(Time_t time) {
+    ProfileEvent(EVENT_TIMER, time);
+    RealScheduleTimer(time);
+}
+
+#endif /* SIM_PROFILE */
@@ -0,0 +1,92 @@
+//
+//  Profile.h
+//  CloudSim
+//
+
+#ifndef Profile_h
+#define Profile_h
+
+// Instrumentation of the scheduler's hot paths. SIM_PROFILE_SCOPE times the rest of the
+// enclosing block into a histogram of the callback, bucketed by powers of two nanoseconds:
+//
+//     SIM_PROFILE_SCOPE(PROFILE_NEW_TASK);
+//
+// Calls the scheduler and the simulator make to the expensive interface functions, and the
+// events the simulator's queue is fed through ScheduleNewTask, ScheduleTaskCompletion,
+// ScheduleMigrationCompletion and ScheduleTimer, are counted through link-time wrappers (see
+// the Makefile). ProfileReport() prints the summary, and setting SIM_PROFILE_JSON=path also
+// writes it to that file as JSON. Setting SIM_EVENT_TRACE=path records every event the queue
+// is fed into that file, as pairs of 64-bit simulated times: when it was scheduled and when it
+// is due. EventBench.cpp replays such traces. Building with PROFILE=1 defines SIM_PROFILE,
+// without it all of this compiles out.
+
+#include <chrono>
+
+#include "Interfaces.h"
+
+typedef enum {
+    PROFILE_NEW_TASK,
+    PROFILE_NEW_TASKS,
+    PROFILE_FIND_MACHINE,
+    PROFILE_TASK_COMPLETE,
+    PROFILE_PERIODIC_CHECK,
+    PROFILE_STATE_CHANGE,
+    PROFILE_MIGRATION_COMPLETE,
+    PROFILE_SLA_WARNING,
+    PROFILE_MEMORY_WARNING,
+    PROFILE_CALLBACKS
+} ProfiledCallback_t;
+
+typedef enum {
+    CALL_MACHINE_GET_INFO,
+    CALL_MACHINE_SET_STATE,
+    CALL_VM_GET_INFO,
+    CALL_VM_CREATE,
+    CALL_VM_ADD_TASK,
+    CALL_VM_MIGRATE,
+    CALL_GET_TASK_INFO,
+    INTERFACE_CALLS
+} InterfaceCall_t;
+
+typedef enum {
+    EVENT_TASK_ARRIVAL,
+    EVENT_TASK_COMPLETION,
+    EVENT_MIGRATION,
+    EVENT_TIMER,
+    EVENT_KINDS
+} ScheduledEvent_t;
+
+#ifdef SIM_PROFILE
+
+extern void ProfileInit();
+extern void ProfileRecord(ProfiledCallback_t callback, uint64_t nanoseconds);
+extern void ProfileEvent(ScheduledEvent_t event, Time_t time);
+extern void ProfileReport();
+
+class ProfileScope {
+public:
+    ProfileScope(ProfiledCallback_t callback) : callback(callback), start(chrono::steady_clock::now()) {}
+    ~ProfileScope() {
+        auto elapsed = chrono::steady_clock::now() - start;
+        ProfileRecord(callback, uint64_t(chrono::duration_cast<chrono::nanoseconds>(elapsed).count()));
+    }
+private:
+    ProfiledCallback_t callback;
+    chrono::steady_clock::time_point start;
+};
+
+#define SIM_PROFILE_CONCAT(a, b)        a##b
+#define SIM_PROFILE_NAME(line)          SIM_PROFILE_CONCAT(profile_scope_, line)
+#define SIM_PROFILE_SCOPE(callback)     ProfileScope SIM_PROFILE_NAME(__LINE__)(callback)
+
+#else
+
+inline void ProfileInit()       {}
+inline void ProfileEvent(ScheduledEvent_t event, Time_t time) {}
+inline void ProfileReport()     {}
+
+#define SIM_PROFILE_SCOPE(callback)     do {} while (0)
+
+#endif /* SIM_PROFILE */
+
+#endif /* Profile_h */
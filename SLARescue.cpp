@@ -0,0 +1,160 @@
+//
+//  SLARescue.cpp
+//  CloudSim
+//
+
+#include <algorithm>
+
+#include "SLARescue.hpp"
+#include "Tuning.h"
+
+
+void SLARescue::Init(const CapacityIndex & index) {
+    this->index = &index;
+    rescues = 0;
+    saved = 0;
+    expired = 0;
+    given_up = 0;
+    moves = 0;
+    stalls = 0;
+}
+
+/**
+ * Project when a running task finishes at the P-state of its machine, tasks beyond the number
+ * of cores sharing them.
+ * @param next_check set to when the task should be checked again if it is on track
+ * @returns true if the task would miss its target completion.
+ */
+bool SLARescue::AtRisk(Time_t now, MachineId_t machine_id, const TaskInfo_t & info, Time_t & next_check) const {
+    const MachineSlot_t & slot = index->Get(machine_id);
+    const vector<unsigned> & mips = index->GetClass(machine_id).performance;
+    if (info.target_completion <= now || mips.size() != P_STATES) {
+        return true;
+    }
+    double share = slot.active_tasks > slot.num_cpus ? double(slot.num_cpus) / slot.active_tasks : 1.0;
+    // MIPS are instructions per microsecond
+    double finish = double(now) + double(info.remaining_instructions) / (mips[slot.p_state] * share);
+    if (finish > double(info.target_completion)) {
+        return true;
+    }
+    next_check = now + max(Time_t((double(info.target_completion) - finish) / 2), Time_t(tuning.min_check_interval));
+    return false;
+}
+
+/**
+ * Tell whether a task at risk can still make its target completion.
+ * @param machine_id the machine running the task
+ * @returns true if its remaining instructions fit before the target completion at P0.
+ */
+bool SLARescue::Savable(Time_t now, MachineId_t machine_id, const TaskInfo_t & info) const {
+    const vector<unsigned> & mips = index->GetClass(machine_id).performance;
+    if (info.completed || info.target_completion <= now || mips.empty()) {
+        return false;
+    }
+    return double(info.remaining_instructions) <= double(mips[P0]) * double(info.target_completion - now);
+}
+
+// Schedules the next check of a task, replacing the one it had
+void SLARescue::Watch(Time_t when, TaskId_t task_id) {
+    Unwatch(task_id);
+    checks.insert({when, task_id});
+    watched.Insert(task_id) = {when, false};
+}
+
+// Queues a waiting task no machine had room for behind the others of its CPU type
+void SLARescue::Stalled(CPUType_t cpu, TaskId_t task_id) {
+    Unwatch(task_id);
+    stalled[cpu].push_back({++stalls, task_id});
+    watched.Insert(task_id) = {stalls, true};
+}
+
+/**
+ * The stalled task of a CPU type that has waited longest, stale entries ahead of it are dropped.
+ * The task stays queued until it is watched again.
+ * @returns the task, or -1 if no task of the CPU type is stalled.
+ */
+TaskId_t SLARescue::NextStalled(CPUType_t cpu) {
+    deque<pair<unsigned, TaskId_t>> & queue = stalled[cpu];
+    while (!queue.empty()) {
+        const pair<Time_t, bool> * current = watched.Find(queue.front().second);
+        if (current != nullptr && current->second && current->first == queue.front().first) {
+            return queue.front().second;
+        }
+        queue.pop_front();
+    }
+    return TaskId_t(-1);
+}
+
+// Checks a stalled task whose machine came up after all at the next check
+void SLARescue::Resumed(Time_t now, TaskId_t task_id) {
+    const pair<Time_t, bool> * check = watched.Find(task_id);
+    if (check != nullptr && check->second) {
+        Watch(now, task_id);
+    }
+}
+
+// Drops the next check of a task, an entry in stalled is left behind and skipped by NextStalled()
+void SLARescue::Unwatch(TaskId_t task_id) {
+    const pair<Time_t, bool> * check = watched.Find(task_id);
+    if (check == nullptr) {
+        return;
+    }
+    if (!check->second) {
+        checks.erase({check->first, task_id});
+    }
+    watched.Erase(task_id);
+}
+
+/**
+ * Take out the watched tasks due for a check, in the order of their checks.
+ * @param task_ids filled with those tasks, the scheduler watches the ones still on track again
+ */
+void SLARescue::Due(Time_t now, vector<TaskId_t> & task_ids) {
+    task_ids.clear();
+    while (!checks.empty() && checks.begin()->first <= now) {
+        task_ids.push_back(checks.begin()->second);
+        watched.Erase(checks.begin()->second);
+        checks.erase(checks.begin());
+    }
+}
+
+// Records a task the scheduler raised to high priority
+void SLARescue::Rescued(TaskId_t task_id, Time_t target_completion) {
+    deadlines.insert({target_completion, task_id});
+    rescued.Insert(task_id) = target_completion;
+    rescues++;
+}
+
+/**
+ * Take out the rescued tasks whose target completion has passed.
+ * @param task_ids filled with those tasks, for the scheduler to return to the priority of their SLA
+ */
+void SLARescue::Expired(Time_t now, vector<TaskId_t> & task_ids) {
+    task_ids.clear();
+    while (!deadlines.empty() && deadlines.begin()->first <= now) {
+        TaskId_t task_id = deadlines.begin()->second;
+        deadlines.erase(deadlines.begin());
+        rescued.Erase(task_id);
+        task_ids.push_back(task_id);
+        expired++;
+    }
+}
+
+void SLARescue::TaskDone(Time_t now, TaskId_t task_id) {
+    Unwatch(task_id);
+    const Time_t * target = rescued.Find(task_id);
+    if (target == nullptr) {
+        return;
+    }
+    if (now <= *target) {
+        saved++;
+    }
+    deadlines.erase({*target, task_id});
+    rescued.Erase(task_id);
+}
+
+void SLARescue::Report() const {
+    cout << "SLA rescues: " << rescues << ", " << saved << " made their target, " << expired << " expired, "
+         << given_up << " past saving" << endl;
+    cout << "Waiting tasks moved to a machine that is up: " << moves << endl;
+}
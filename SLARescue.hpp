@@ -0,0 +1,63 @@
+//
+//  SLARescue.hpp
+//  CloudSim
+//
+
+#ifndef SLARescue_hpp
+#define SLARescue_hpp
+
+#include <deque>
+#include <set>
+#include <vector>
+
+#include "CapacityIndex.hpp"
+#include "SlotTable.hpp"
+
+// Finds the tasks heading for an SLA violation while they can still be saved. The simulator's
+// SLA warning only comes once a task is already late, so every task with an SLA is watched from
+// its placement instead: each check projects its finish from its remaining instructions and the
+// speed of its share of the machine, and schedules the next check halfway to the point where
+// the projection would cross its target completion. A task found at risk that can still make its
+// target at P0 is rescued, the scheduler raises it to high priority; a task still waiting for its
+// machine to wake up is moved to one that is up. Rescued tasks are ordered by target completion,
+// once it has passed the task goes back to the priority of its SLA. Every update is O(log n) in
+// the tasks watched. Waiting tasks that found no room queue per CPU type in the order they
+// stalled, the scheduler takes them out from the front when capacity frees up on that type.
+class SLARescue {
+public:
+    SLARescue()                 {}
+    void Init(const CapacityIndex & index);
+    bool AtRisk(Time_t now, MachineId_t machine_id, const TaskInfo_t & info, Time_t & next_check) const;
+    bool Savable(Time_t now, MachineId_t machine_id, const TaskInfo_t & info) const;
+
+    void Watch(Time_t when, TaskId_t task_id);
+    void Stalled(CPUType_t cpu, TaskId_t task_id);
+    TaskId_t NextStalled(CPUType_t cpu);
+    void Resumed(Time_t now, TaskId_t task_id);
+    void Due(Time_t now, vector<TaskId_t> & task_ids);
+    void Rescued(TaskId_t task_id, Time_t target_completion);
+    void Moved()                { moves++; }
+    void GaveUp()               { given_up++; }
+    void Expired(Time_t now, vector<TaskId_t> & task_ids);
+    void TaskDone(Time_t now, TaskId_t task_id);
+    void Report() const;
+private:
+    void Unwatch(TaskId_t task_id);
+
+    set<pair<Time_t, TaskId_t>> checks;     // Watched tasks by the time of their next check
+    deque<pair<unsigned, TaskId_t>> stalled[CPU_TYPES];    // Stalled tasks of each CPU type with their stall number,
+                                                            // entries of tasks watched since are stale
+    SlotTable<pair<Time_t, bool>> watched;  // Next check of each watched task, or its stall number if it is stalled
+    set<pair<Time_t, TaskId_t>> deadlines;  // Rescued tasks by target completion
+    SlotTable<Time_t> rescued;              // Target completion of each rescued task
+
+    const CapacityIndex * index;
+    unsigned rescues;
+    unsigned saved;
+    unsigned expired;
+    unsigned given_up;
+    unsigned moves;
+    unsigned stalls;
+};
+
+#endif /* SLARescue_hpp */
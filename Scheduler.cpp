@@ -6,21 +6,30 @@
 //
 
 #include <cassert>
+#include <climits>
 
+#include "Internal_Interfaces.h"
+#include "Logging.h"
+#include "Policies.hpp"
+#include "Profile.h"
 #include "Scheduler.hpp"
+#include "Telemetry.h"
+#include "Tuning.h"
 
-// static bool migrating = false;
-static unsigned active_machines;
-static vector<vector<VMId_t>> vms_per_machine;
-
-static map<VMId_t, bool> migration;
-static map<MachineId_t, bool> stateChange;
+using namespace std;
 
-static map<VMId_t, vector<TaskId_t>> pendingTasks;
+// VMs of an overcommitted machine that may find nowhere to go before it waits for capacity
+#define MAX_EVICTION_FAILURES 4
 
-static map<MachineId_t, vector<VMId_t>> pendingVMs;
+// The memory an overcommitted machine must get back under before it takes placements again
+static unsigned HighWater(const MachineSlot_t & slot) {
+    return unsigned(slot.memory_size * tuning.memory_high_water);
+}
 
-using namespace std;
+// A task that waited for its machine makes up for it at high priority, SLA3 tasks stay at low
+static Priority_t WaitedPriority(SLAType_t sla) {
+    return sla == SLA3 ? LOW_PRIORITY : HIGH_PRIORITY;
+}
 
 void Scheduler::Init() {
     // Find the parameters of the clusters
@@ -33,110 +42,231 @@ void Scheduler::Init() {
     // 
     active_machines = Machine_GetTotal();
     vms_per_machine = vector<vector<VMId_t>>(active_machines);
+    pendingVMs = vector<vector<VMId_t>>(active_machines);
+    stateChange = vector<bool>(active_machines, false);
     
     std::cout << "Scheduler::Init(): Total number of machines is " + to_string(Machine_GetTotal()) << std::endl;
-    SimOutput("Scheduler::Init(): Initializing scheduler", 1);
+    SIM_LOG(1, "Scheduler::Init(): Initializing scheduler");
 
 
     cout << "Number of tasks: " << GetNumTasks() << endl;
 
     for(unsigned i = 0; i < active_machines; i++) {
         machines.push_back(MachineId_t(i));
-        stateChange[machines[i]] = false;
     }
+    index.Init();
+    power.Init(index);
+    placement.Init(index, power);
+    dvfs.Init(index);
+    consolidator.Init(index);
+    rescue.Init(index);
+    pool.Init();
+    memory_warnings = 0;
+    evicted = 0;
+    evicted_tasks = 0;
+    evictable = vector<set<pair<double, VMId_t>>>(active_machines);
+    leaving = vector<unsigned>(active_machines, 0);
+    fill(freed, freed + CPU_TYPES, false);
+    queued = 0;
+    fill(unplaced_demand, unplaced_demand + CPU_TYPES * 2, 0);
 }
 
 void Scheduler::MigrationComplete(Time_t time, VMId_t vm_id) {
     // Update your data structure. The VM now can receive new tasks
-    SimOutput("Migration has completed for id : " + to_string(vm_id) + " at time " + to_string(time), 3);
-    migration[vm_id] = false;
-
-    for (unsigned i = 0; i < pendingTasks[vm_id].size(); ++i) {
-        VM_AddTask(vm_id, pendingTasks[vm_id][i], HIGH_PRIORITY);
+    SIM_LOG(3, "Migration has completed for id : ", vm_id, " at time ", time);
+    VMRecord_t & record = vm_records[vm_id];
+    record.migrating = false;
+
+    // Move the VM's footprint from the source to the target. The target was charged the
+    // full VM when the migration started, settle the difference with what changed since.
+    MachineId_t source = record.machine_id;
+    leaving[source] -= record.reserved;
+    ReleaseMemory(source, record.memory);
+    if (record.reserved > record.memory) {
+        ReleaseMemory(record.target, record.reserved - record.memory);
+    } else {
+        index.AddMemory(record.target, record.memory - record.reserved);
+    }
+    for (TaskId_t task_id : record.active_tasks) {
+        index.RemoveTask(source);
+        index.AddTask(record.target);
+        const TaskPace_t & pace = task_records[task_id].pace;
+        dvfs.Remove(source, pace);
+        dvfs.Add(record.target, pace);
+    }
+    index.RemoveVM(source);
+    index.AddVM(record.target);
+    vector<VMId_t> & source_vms = vms_per_machine[source];
+    source_vms.erase(find(source_vms.begin(), source_vms.end(), vm_id));
+    vms_per_machine[record.target].push_back(vm_id);
+    pool.Move(vm_id, source, record.target, record.vm_type, record.cpu);
+    record.machine_id = record.target;
+    Rank(vm_id);
+
+    const vector<TaskId_t> * waiting = pendingTasks.Find(vm_id);
+    if (waiting != nullptr) {
+        for (TaskId_t task_id : *waiting) {
+            task_records[task_id].waiting = NOT_WAITING;
+            rescue.Resumed(time, task_id);
+            VM_AddTask(vm_id, task_id, WaitedPriority(task_records[task_id].sla));
+        }
+        pendingTasks.Erase(vm_id);
+    }
+    if (consolidator.Completed(time, vm_id) && !index.Get(source).fenced) {
+        // The last VM has left, the machine can take work or be put to sleep again
+        index.SetListed(source, true);
     }
+    AdjustPerformance(time, source);
+    AdjustPerformance(time, record.machine_id);
+    RetryStalled(time, record.cpu);
 }
 
 void Scheduler::HandleStateChange(Time_t time, MachineId_t machine_id) {
-    SimOutput("State change has completed for id : " + to_string(machine_id) + " at time " + to_string(time), 3);
+    SIM_LOG(3, "State change has completed for id : ", machine_id, " at time ", time);
     stateChange[machine_id] = false;
+    power.StateChanged(time, machine_id);
+    if (index.Get(machine_id).s_state != S0 && !pendingVMs[machine_id].empty()) {
+        // Work arrived while the machine was going into the warm pool, bring it back up
+        SetMachineState(time, machine_id, S0);
+        return;
+    }
+    // A machine that went to sleep can be woken up for placements again
+    index.SetListed(machine_id, true);
+    if (index.Get(machine_id).s_state == S0) {
+        freed[index.Get(machine_id).cpu] = true;
+    }
 
-    for (unsigned i = 0; i < pendingVMs[machine_id].size(); ++i) {
-        VM_Attach(pendingVMs[machine_id][i], machine_id);
-        for (unsigned j = 0; j < pendingTasks[pendingVMs[machine_id][i]].size(); ++j) {
-            VM_AddTask(pendingVMs[machine_id][i], pendingTasks[pendingVMs[machine_id][i]][j], HIGH_PRIORITY);
+    for (VMId_t vm_id : pendingVMs[machine_id]) {
+        VM_Attach(vm_id, machine_id);
+        const vector<TaskId_t> * waiting = pendingTasks.Find(vm_id);
+        if (waiting != nullptr) {
+            for (TaskId_t task_id : *waiting) {
+                task_records[task_id].waiting = NOT_WAITING;
+                rescue.Resumed(time, task_id);
+                VM_AddTask(vm_id, task_id, WaitedPriority(task_records[task_id].sla));
+            }
+            pendingTasks.Erase(vm_id);
         }
     }
+    pendingVMs[machine_id].clear();
+    AdjustPerformance(time, machine_id);
+    if (index.Get(machine_id).s_state == S0) {
+        RetryStalled(time, index.Get(machine_id).cpu);
+    }
 }
 
-void Scheduler::NewTask(Time_t now, TaskId_t task_id) {
-    bool gpu = IsTaskGPUCapable(task_id);
-    unsigned int task_mem = GetTaskMemory(task_id) + VM_MEMORY_OVERHEAD;
-    VMType_t vm_type = RequiredVMType(task_id);
-    CPUType_t cpu = RequiredCPUType(task_id);
-    SLAType_t sla = RequiredSLA(task_id);
-
-    // SimOutput("Task ID " + to_string(task_id) + " is projected to take : " 
-    //     + to_string(GetTaskInfo(task_id).target_completion - GetTaskInfo(task_id).arrival) + " amount of time.", 3);
-    
+Priority_t Scheduler::TaskPriority(TaskId_t task_id) {
     // SLA0: high priority
     // SLA1, SLA2: mid priority
     // SLA3: low priority
+    SLAType_t sla = RequiredSLA(task_id);
     Priority_t priority = LOW_PRIORITY;
     if (sla == SLA0) {
         priority = HIGH_PRIORITY;
     } else if (sla == SLA1 || sla == SLA2) {
         priority = MID_PRIORITY;
     }
+    return priority;
+}
 
-    
-    SimOutput("Attempting to look for machine to place new task in with task id " + to_string(task_id), 3);
-    auto ret = FindMachine(gpu, task_mem, cpu, vm_type);
-    MachineId_t machine_id = ret.first;
-    VMId_t vm_id = ret.second;
-
-    if (machine_id == active_machines + 1) {
-        SimOutput("Unable to find machine for task with id " + to_string(task_id), 3);
-        return;
-    }
-
-    bool taskMustWait = false;
-
-    if (vm_id == VMId_t(-1)) {
+/**
+ * Place a task on a machine, creating a VM for it if needed. A machine that is not up
+ * is woken and the task waits in pendingTasks until HandleStateChange attaches it.
+ * @param info the task to place, as GetTaskInfo() returned it to FindMachine
+ * @param machine_id the machine returned by FindMachine
+ * @param vm_id the VM returned by FindMachine, -1 to create a new one
+ * @param priority the priority to run the task at
+ */
+void Scheduler::PlaceTask(const TaskInfo_t & info, MachineId_t machine_id, VMId_t vm_id, Priority_t priority) {
+    TaskId_t task_id = info.task_id;
+    VMType_t vm_type = info.required_vm;
+    CPUType_t cpu = info.required_cpu;
+    unsigned waiting_at = NOT_WAITING;
+    bool created = vm_id == VMId_t(-1);
+    // A task moved off its machine keeps its record until it is placed again
+    bool moved = task_records.Contains(task_id);
+
+    if (created) {
         vm_id = VM_Create(vm_type, cpu);
-        SimOutput("Initializing VM with id " + to_string(vm_id), 3);
+        SIM_LOG(3, "Initializing VM with id ", vm_id);
 
-        if (Machine_GetInfo(machine_id).s_state == S5) {
+        if (stateChange[machine_id] || index.Get(machine_id).s_state != S0) {
             pendingVMs[machine_id].push_back(vm_id);
-            pendingTasks[vm_id].push_back(task_id);
-            SimOutput("VM " + to_string(vm_id) + " waits to be added to Machine " + to_string(machine_id), 3);
-            taskMustWait = true;
-            stateChange[machine_id] = true;
-            Machine_SetState(machine_id, S0);
+            vector<TaskId_t> & waiting = pendingTasks.Insert(vm_id);
+            waiting.clear();
+            waiting.push_back(task_id);
+            SIM_LOG(3, "VM ", vm_id, " waits to be added to Machine ", machine_id);
+            waiting_at = 0;
+            if (!stateChange[machine_id]) {
+                SetMachineState(Now(), machine_id, S0);
+            }
         } else {
             VM_Attach(vm_id, machine_id);
-            SimOutput("Attached VM " + to_string(vm_id) + " to Machine " + to_string(machine_id), 3);
+            SIM_LOG(3, "Attached VM ", vm_id, " to Machine ", machine_id);
         }
 
-        vms.push_back(vm_id);
-
-        migration[vm_id] = false;
         vms_per_machine[machine_id].push_back(vm_id);
+        pool.Add(vm_id, machine_id, vm_type, cpu);
+        // A recycled record keeps the capacity of its task list
+        VMRecord_t & record = vm_records.Insert(vm_id);
+        record.vm_type = vm_type;
+        record.cpu = cpu;
+        record.machine_id = machine_id;
+        record.target = machine_id;
+        record.memory = VM_MEMORY_OVERHEAD;
+        record.reserved = 0;
+        record.cost = 0;
+        record.rank = 0;
+        record.migrating = false;
+        record.active_tasks.clear();
+        index.AddVM(machine_id);
+        index.AddMemory(machine_id, VM_MEMORY_OVERHEAD);
     } else {
-        SimOutput("Using pre-existing VM " + to_string(vm_id) + " on Machine " + to_string(machine_id), 3);
-        SimOutput("VM CPU type : " + to_string(VM_GetInfo(vm_id).cpu) + ", and task CPU type" + to_string(GetTaskInfo(task_id).required_cpu) + 
-        ", coupled with machine CPU type " + to_string(Machine_GetCPUType(machine_id)), 3);
+        SIM_LOG(3, "Using pre-existing VM ", vm_id, " on Machine ", machine_id);
+        if (stateChange[machine_id] || vm_records[vm_id].migrating) {
+            if (!pendingTasks.Contains(vm_id)) {
+                pendingTasks.Insert(vm_id).clear();
+            }
+            vector<TaskId_t> & waiting = pendingTasks[vm_id];
+            waiting_at = unsigned(waiting.size());
+            waiting.push_back(task_id);
+        }
+    }
+
+    unsigned mem = info.required_memory;
+    SLAType_t sla = info.required_sla;
+    unsigned cost = SLA3 - sla + 1;
+    VMRecord_t & record = vm_records[vm_id];
+    record.memory += mem;
+    record.cost += cost;
+    Rank(vm_id);
+    record.active_tasks.push_back(task_id);
+    pool.Placed(vm_id, created, moved);
+    Time_t start = Now() + power.WakeDelay(Now(), record.machine_id);
+    TaskPace_t pace = DVFSController::Pace(start, info.remaining_instructions, info.target_completion, sla);
+    unsigned position = unsigned(record.active_tasks.size() - 1);
+    task_records.Insert(task_id) = {vm_id, position, waiting_at, mem, cost, sla, Now(), power.StartKind(record.machine_id), pace};
+    dvfs.Add(record.machine_id, pace);
+    power.TaskPlaced(index.Get(record.machine_id).cpu, index.Get(record.machine_id).gpus);
+    if (sla != SLA3) {
+        rescue.Watch(Now(), task_id);
     }
+    index.AddTask(record.machine_id);
+    index.AddMemory(record.machine_id, mem);
 
-    if (!taskMustWait) {
+    if (waiting_at == NOT_WAITING) {
         VM_AddTask(vm_id, task_id, priority);
-        SimOutput("Task with task id " + to_string(task_id) + " placed successfully on machine " + to_string(machine_id), 3);
+        SIM_LOG(3, "Task with task id ", task_id, " placed successfully on machine ", machine_id);
+        AdjustPerformance(Now(), machine_id);
     } else {
-        SimOutput("Task with task id " + to_string(task_id) + " awaits placement on machine " + to_string(machine_id), 3);
+        SIM_LOG(3, "Task with task id ", task_id, " awaits placement on machine ", machine_id);
     }
 }
 
 /**
- * Find a machine id capable of handling the needs of a specific task.
+ * Find a machine id capable of handling the needs of a specific task, the one where it costs
+ * the least by the placement model (see Placement.hpp).
+ * @param info the task to place
  * @param prefer_gpu true if task prefers machines with gpus
  * @param task_mem the memory a task takes up
  * @param cpu the cpu type of the task
@@ -145,23 +275,551 @@ void Scheduler::NewTask(Time_t now, TaskId_t task_id) {
  * If machine id is -1, failed to find a machine. 
  * If vm id is -1, no vm on that machine has the required vm type.
  */
-pair<MachineId_t, VMId_t> Scheduler::FindMachine(bool prefer_gpu, unsigned int task_mem, CPUType_t cpu, VMType_t vm_type) {
-    return {-1, -1};
+pair<MachineId_t, VMId_t> Scheduler::FindMachine(const TaskInfo_t & info, bool prefer_gpu, unsigned int task_mem, CPUType_t cpu, VMType_t vm_type) {
+    Demand_t demand = {info.remaining_instructions, info.target_completion, info.required_sla, prefer_gpu, task_mem, cpu};
+    MachineId_t machine_id = placement.Find(Now(), demand);
+    if (machine_id == MachineId_t(-1)) {
+        // No machine has room, the task is queued rather than overcommit one
+        return {-1, -1};
+    }
+    return {machine_id, find_vm(*this, machine_id, vm_type, cpu)};
+}
+
+/**
+ * Find a VM on a machine that can host a task, through the VM pool. A VM holds at most one
+ * task per core of its machine, so that it fits on an empty machine of the class when it has
+ * to be evicted or consolidated.
+ * @returns the VM id, or -1 if no VM on the machine has the required type and room.
+ */
+VMId_t Scheduler::FindVM(MachineId_t machine_id, VMType_t vm_type, CPUType_t cpu) {
+    unsigned cores = index.Get(machine_id).num_cpus;
+    return pool.Find(machine_id, vm_type, cpu, [this, cores](VMId_t vm_id) {
+        return vm_records[vm_id].active_tasks.size() < cores;
+    });
+}
+
+/**
+ * Start migrating a VM, charging the target machine for it right away so that
+ * placements made during the migration do not overcommit the target.
+ * @param vm_id the VM to migrate
+ * @param machine_id the machine to migrate the VM to
+ */
+void Scheduler::MigrateVM(VMId_t vm_id, MachineId_t machine_id) {
+    VMRecord_t & record = vm_records[vm_id];
+    record.target = machine_id;
+    record.reserved = record.memory;
+    index.AddMemory(machine_id, record.memory);
+    Unrank(vm_id);
+    record.migrating = true;
+    leaving[record.machine_id] += record.reserved;
+    VM_Migrate(vm_id, machine_id);
+}
+
+
+/**
+ * Move a machine to another S-state. A machine heading to S5 is unlisted until it gets there,
+ * any other stays listed and tasks placed on it wait in pendingTasks until it is up.
+ * @param s_state the state to move the machine to
+ * @param ahead true if the machine is woken ahead of demand rather than for a task
+ */
+void Scheduler::SetMachineState(Time_t now, MachineId_t machine_id, MachineState_t s_state, bool ahead) {
+    power.StateRequested(now, machine_id, s_state, ahead);
+    Machine_SetState(machine_id, s_state);
+    stateChange[machine_id] = true;
+    if (s_state == S5) {
+        index.SetListed(machine_id, false);
+    }
+    index.SetState(machine_id, s_state);
+}
+
+/**
+ * Set the P-state of a machine from the pace of its tasks (see DVFS.hpp). Called whenever
+ * the tasks of a machine change, so only the machines affected by an event are visited.
+ * Machines that are not up keep their P-state until they are.
+ */
+void Scheduler::AdjustPerformance(Time_t now, MachineId_t machine_id) {
+    const MachineSlot_t & slot = index.Get(machine_id);
+    if (stateChange[machine_id] || slot.s_state != S0) {
+        return;
+    }
+    CPUPerformance_t p_state = dvfs.Select(now, machine_id);
+    if (p_state != slot.p_state) {
+        SIM_LOG(3, "Setting machine ", machine_id, " to P-state ", p_state, " at time ", now);
+        // The simulator sets every core of the machine, whatever core is passed
+        Machine_SetCorePerformance(machine_id, 0, p_state);
+        index.SetPerformance(machine_id, p_state);
+    }
+}
+
+/**
+ * Pack the VMs of lightly loaded machines onto busier machines of the same CPU type, so the
+ * donors empty out and go to the warm pool or S5. A donor is only drained when every one of
+ * its VMs can leave: VMs without tasks are shut down and the others migrated, each to the best
+ * fit machine that has the cores and memory for it and that the cost model accepts. The donor
+ * takes no new work until its last VM has left.
+ */
+void Scheduler::Consolidate(Time_t now) {
+    unsigned room = consolidator.Room();
+    if (room == 0 || index.Light().empty()) {
+        return;
+    }
+    donors.assign(index.Light().begin(), index.Light().end());
+    stable_sort(donors.begin(), donors.end(), [this](MachineId_t lhs, MachineId_t rhs) {
+        return index.Get(lhs).active_tasks < index.Get(rhs).active_tasks;
+    });
+
+    for (MachineId_t donor : donors) {
+        const MachineSlot_t & source = index.Get(donor);
+        if (stateChange[donor] || !source.listed || vms_per_machine[donor].size() > room) {
+            continue;
+        }
+        plan.clear();
+        bool drainable = true;
+        for (VMId_t vm_id : vms_per_machine[donor]) {
+            const VMRecord_t & record = vm_records[vm_id];
+            if (record.migrating || pendingTasks.Contains(vm_id)) {
+                drainable = false;
+                break;
+            }
+            if (record.active_tasks.empty()) {
+                plan.push_back({vm_id, MachineId_t(-1)});
+                continue;
+            }
+            unsigned cores = unsigned(record.active_tasks.size());
+            auto accept = [&](MachineId_t machine_id) {
+                const MachineSlot_t & slot = index.Get(machine_id);
+                // Earlier VMs of the plan are not charged to their target yet
+                unsigned planned_cores = 0, planned_memory = 0;
+                for (const auto & step : plan) {
+                    if (step.second == machine_id) {
+                        planned_cores += unsigned(vm_records[step.first].active_tasks.size());
+                        planned_memory += vm_records[step.first].memory;
+                    }
+                }
+                return machine_id != donor && !stateChange[machine_id] && slot.active_tasks > source.active_tasks &&
+                       slot.active_tasks + consolidator.Incoming(machine_id) + planned_cores + cores <= slot.num_cpus &&
+                       slot.memory_used + planned_memory + record.memory <= slot.memory_size &&
+                       consolidator.WorthMoving(now, donor, machine_id, record.active_tasks);
+            };
+            MachineId_t target = index.FindUp(source.gpus, record.memory, record.cpu, accept);
+            if (target == MachineId_t(-1)) {
+                target = index.FindUp(!source.gpus, record.memory, record.cpu, accept);
+            }
+            if (target == MachineId_t(-1)) {
+                drainable = false;
+                break;
+            }
+            plan.push_back({vm_id, target});
+        }
+        // Machines holding only idle VMs are left alone, draining is about moving work
+        if (!drainable || all_of(plan.begin(), plan.end(), [](const pair<VMId_t, MachineId_t> & step) { return step.second == MachineId_t(-1); })) {
+            continue;
+        }
+
+        unsigned migrating = 0;
+        for (const auto & step : plan) {
+            if (step.second == MachineId_t(-1)) {
+                SIM_LOG(3, "Shutting down idle VM ", step.first, " on machine ", donor);
+                ShutdownVM(step.first);
+                continue;
+            }
+            const VMRecord_t & record = vm_records[step.first];
+            SIM_LOG(3, "Migrating VM ", step.first, " from machine ", donor, " to machine ", step.second, " at time ", now);
+            consolidator.Started(now, step.first, donor, step.second, unsigned(record.active_tasks.size()));
+            MigrateVM(step.first, step.second);
+            migrating++;
+        }
+        if (migrating > 0) {
+            index.SetListed(donor, false);
+            room -= migrating;
+        }
+        if (room == 0) {
+            break;
+        }
+    }
+}
+
+/**
+ * Shut down a VM that runs no task and release what it holds on its machine.
+ */
+void Scheduler::ShutdownVM(VMId_t vm_id) {
+    VMRecord_t & record = vm_records[vm_id];
+    Unrank(vm_id);
+    VM_Shutdown(vm_id);
+    index.RemoveVM(record.machine_id);
+    ReleaseMemory(record.machine_id, record.memory);
+    vector<VMId_t> & machine_vms = vms_per_machine[record.machine_id];
+    machine_vms.erase(find(machine_vms.begin(), machine_vms.end(), vm_id));
+    pool.Remove(vm_id, record.machine_id, record.vm_type, record.cpu);
+    vm_records.Erase(vm_id);
+}
+
+/**
+ * Shut down the VMs idle for longer than tuning.vm_idle_time. Their memory goes back to the
+ * machine, and a machine left with no VM can go to the warm pool or S5. VMs migrating or on a
+ * machine changing state are left for a later check.
+ */
+void Scheduler::RetireIdleVMs(Time_t now) {
+    Time_t idle_time = Time_t(tuning.vm_idle_time);
+    if (now < idle_time) {
+        return;
+    }
+    pool.Expired(now - idle_time, retiring);
+    for (VMId_t vm_id : retiring) {
+        const VMRecord_t & record = vm_records[vm_id];
+        if (record.migrating || stateChange[record.machine_id] || pendingTasks.Contains(vm_id)) {
+            continue;
+        }
+        SIM_LOG(3, "Retiring idle VM ", vm_id, " on machine ", record.machine_id, " at time ", now);
+        ShutdownVM(vm_id);
+        pool.Retired();
+    }
+}
+
+/**
+ * Release memory the scheduler charged to a machine. A fenced machine that gets back under its
+ * high-water mark takes placements again, the fenced machines of its CPU type are retried.
+ */
+void Scheduler::ReleaseMemory(MachineId_t machine_id, unsigned memory) {
+    index.RemoveMemory(machine_id, memory);
+    freed[index.Get(machine_id).cpu] = true;
+    if (index.Get(machine_id).fenced && index.Get(machine_id).memory_used <= HighWater(index.Get(machine_id))) {
+        SIM_LOG(3, "Machine ", machine_id, " is back under its high-water mark");
+        index.SetFenced(machine_id, false);
+        // A machine being drained stays unlisted until its last VM has left
+        if (!consolidator.Draining(machine_id)) {
+            index.SetListed(machine_id, true);
+        }
+    }
+}
+
+/**
+ * Bring an overcommitted machine back under its high-water mark. Its VMs are kept in order of
+ * cost per megabyte freed, the cost being their tasks weighted by SLA, so idle VMs are shut down
+ * first and VMs holding few tasks with lax SLAs move next. Each goes to the best fit machine of
+ * its CPU type that is up, has the cores for it and stays under its own high-water mark. A VM
+ * that cannot move whole sheds the tasks waiting in it one by one, the tasks running in it
+ * cannot leave their VM. After MAX_EVICTION_FAILURES VMs found nowhere to go the machine is
+ * left fenced until capacity frees up on its CPU type.
+ * @returns true if anything left the machine.
+ */
+bool Scheduler::EvictVMs(Time_t now, MachineId_t machine_id) {
+    const MachineSlot_t & slot = index.Get(machine_id);
+    set<pair<double, VMId_t>> & order = evictable[machine_id];
+    unsigned failures = 0;
+    bool moved = false;
+    auto it = order.begin();
+    while (it != order.end() && failures < MAX_EVICTION_FAILURES && slot.memory_used > HighWater(slot) + leaving[machine_id]) {
+        // Evicting the VM takes it out of the order, step past it first
+        VMId_t vm_id = (it++)->second;
+        const VMRecord_t & record = vm_records[vm_id];
+        const vector<TaskId_t> * waiting = pendingTasks.Find(vm_id);
+        if (waiting != nullptr) {
+            // Moving the last waiting task forgets the VM, walk a copy
+            moving.assign(waiting->begin(), waiting->end());
+            bool shed = false;
+            for (TaskId_t task_id : moving) {
+                if (MoveWaitingTask(now, task_id) == MachineId_t(-1)) {
+                    break;
+                }
+                evicted_tasks++;
+                shed = true;
+            }
+            failures += !shed;
+            moved |= shed;
+            continue;
+        }
+        if (record.active_tasks.empty()) {
+            SIM_LOG(3, "Shutting down idle VM ", vm_id, " on overcommitted machine ", machine_id);
+            ShutdownVM(vm_id);
+            moved = true;
+            continue;
+        }
+        unsigned cores = unsigned(record.active_tasks.size());
+        auto accept = [&](MachineId_t target_id) {
+            const MachineSlot_t & target = index.Get(target_id);
+            return target_id != machine_id && !stateChange[target_id] &&
+                   target.active_tasks + consolidator.Incoming(target_id) + cores <= target.num_cpus &&
+                   target.memory_used + record.memory <= HighWater(target);
+        };
+        MachineId_t target = index.FindUp(slot.gpus, record.memory, record.cpu, accept);
+        if (target == MachineId_t(-1)) {
+            target = index.FindUp(!slot.gpus, record.memory, record.cpu, accept);
+        }
+        if (target == MachineId_t(-1)) {
+            // A smaller VM further down may still fit somewhere
+            failures++;
+            continue;
+        }
+        SIM_LOG(3, "Evicting VM ", vm_id, " from machine ", machine_id, " to machine ", target, " at time ", now);
+        MigrateVM(vm_id, target);
+        evicted++;
+        moved = true;
+    }
+    return moved;
+}
+
+// Files a VM under its machine in eviction order after its tasks changed, a migrating VM is
+// filed under its target once it gets there
+void Scheduler::Rank(VMId_t vm_id) {
+    VMRecord_t & record = vm_records[vm_id];
+    if (record.migrating) {
+        return;
+    }
+    set<pair<double, VMId_t>> & order = evictable[record.machine_id];
+    order.erase({record.rank, vm_id});
+    record.rank = double(record.cost) / record.memory;
+    order.insert({record.rank, vm_id});
+}
+
+void Scheduler::Unrank(VMId_t vm_id) {
+    const VMRecord_t & record = vm_records[vm_id];
+    evictable[record.machine_id].erase({record.rank, vm_id});
+}
+
+/**
+ * Retry the fenced machines of the CPU types where memory freed up since the last check, the
+ * most overcommitted first, until one of them finds nowhere to move anything.
+ */
+void Scheduler::RetryEvictions(Time_t now) {
+    for (unsigned cpu = 0; cpu < CPU_TYPES; cpu++) {
+        if (!freed[cpu]) {
+            continue;
+        }
+        freed[cpu] = false;
+        // Evicting re-files a machine by its memory used, so step down from the last one visited
+        const set<pair<unsigned, MachineId_t>> & fenced = index.FencedByMemory(CPUType_t(cpu));
+        pair<unsigned, MachineId_t> last = {UINT_MAX, MachineId_t(-1)};
+        for (size_t visits = fenced.size(); visits > 0; visits--) {
+            auto it = fenced.lower_bound(last);
+            if (it == fenced.begin()) {
+                break;
+            }
+            last = *--it;
+            if (!stateChange[last.second] && !EvictVMs(now, last.second)) {
+                break;
+            }
+        }
+    }
+}
+
+// True while a task waits in pendingTasks for its machine to wake up or its VM to finish migrating
+bool Scheduler::IsWaiting(TaskId_t task_id) {
+    return task_records[task_id].waiting != NOT_WAITING;
+}
+
+/**
+ * Take a task out of a task list in constant time, the last task of the list takes its place.
+ * @param field the member of TaskRecord_t holding the position of a task in the list
+ */
+void Scheduler::SwapOut(vector<TaskId_t> & tasks, unsigned position, unsigned TaskRecord_t::* field) {
+    TaskId_t last = tasks.back();
+    tasks[position] = last;
+    task_records[last].*field = position;
+    tasks.pop_back();
 }
 
+/**
+ * Move a waiting task to a machine that is up and has a spare core. Only waiting tasks can
+ * move, the simulator does not carry a task removed from a VM over to another one.
+ * @returns the machine the task now runs on, or -1 if no machine has room.
+ */
+MachineId_t Scheduler::MoveWaitingTask(Time_t now, TaskId_t task_id) {
+    TaskRecord_t & task = task_records[task_id];
+    VMId_t vm_id = task.vm_id;
+    VMRecord_t & record = vm_records[vm_id];
+    MachineId_t source = record.machine_id;
+    CPUType_t cpu = record.cpu;
+    unsigned memory = task.memory + VM_MEMORY_OVERHEAD;
+    auto accept = [&](MachineId_t machine_id) {
+        const MachineSlot_t & slot = index.Get(machine_id);
+        return machine_id != source && !stateChange[machine_id] && slot.active_tasks < slot.num_cpus &&
+               slot.memory_used + memory <= slot.memory_size;
+    };
+    bool gpu = IsTaskGPUCapable(task_id);
+    MachineId_t target = index.FindUp(gpu, memory, cpu, accept);
+    if (target == MachineId_t(-1)) {
+        target = index.FindUp(!gpu, memory, cpu, accept);
+    }
+    if (target == MachineId_t(-1)) {
+        return MachineId_t(-1);
+    }
+
+    SIM_LOG(3, "Moving waiting task ", task_id, " from machine ", source, " to machine ", target, " at time ", now);
+    vector<TaskId_t> & waiting = pendingTasks[vm_id];
+    SwapOut(waiting, task.waiting, &TaskRecord_t::waiting);
+    record.memory -= task.memory;
+    record.cost -= task.cost;
+    Rank(vm_id);
+    SwapOut(record.active_tasks, task.position, &TaskRecord_t::position);
+    index.RemoveTask(source);
+    ReleaseMemory(source, task.memory);
+    dvfs.Remove(source, task.pace);
+    if (waiting.empty() && !record.migrating) {
+        // The VM was created for tasks that have all left and was never attached, forget it
+        vector<VMId_t> & machine_pending = pendingVMs[source];
+        machine_pending.erase(find(machine_pending.begin(), machine_pending.end(), vm_id));
+        vector<VMId_t> & machine_vms = vms_per_machine[source];
+        machine_vms.erase(find(machine_vms.begin(), machine_vms.end(), vm_id));
+        pool.Remove(vm_id, source, record.vm_type, cpu);
+        index.RemoveVM(source);
+        ReleaseMemory(source, record.memory);
+        Unrank(vm_id);
+        pendingTasks.Erase(vm_id);
+        vm_records.Erase(vm_id);
+    } else if (record.active_tasks.empty()) {
+        pool.Idle(now, vm_id);
+    }
+
+    // The task keeps the time it was first placed at, its run time counts the wait
+    Time_t placed = task.placed;
+    TaskInfo_t info = GetTaskInfo(task_id);
+    PlaceTask(info, target, find_vm(*this, target, info.required_vm, cpu), WaitedPriority(task.sla));
+    task_records[task_id].placed = placed;
+    return target;
+}
+
+/**
+ * Check a task with an SLA against its target completion. A waiting task moves to a machine
+ * that is up if one has room, otherwise it stalls until capacity frees up on its CPU type. A
+ * running task found at risk is rescued if it can still make its target: it runs at high
+ * priority and P0, SLA3 tasks already run at low priority. A task on track is watched again.
+ */
+void Scheduler::CheckTask(Time_t now, TaskId_t task_id) {
+    if (!task_records.Contains(task_id) || IsTaskCompleted(task_id)) {
+        return;
+    }
+    if (IsWaiting(task_id)) {
+        // Once a task found no room during this check, larger tasks of its CPU type do not look
+        const TaskRecord_t & task = task_records[task_id];
+        unsigned & limit = no_room[vm_records[task.vm_id].cpu];
+        if (task.memory < limit) {
+            if (MoveWaitingTask(now, task_id) != MachineId_t(-1)) {
+                rescue.Moved();
+                rescue.Watch(now, task_id);
+                return;
+            }
+            limit = task.memory;
+        }
+        rescue.Stalled(vm_records[task.vm_id].cpu, task_id);
+        return;
+    }
+    MachineId_t machine_id = vm_records[task_records[task_id].vm_id].machine_id;
+    TaskInfo_t info = GetTaskInfo(task_id);
+    Time_t next_check;
+    if (!rescue.AtRisk(now, machine_id, info, next_check)) {
+        rescue.Watch(next_check, task_id);
+        return;
+    }
+    if (!rescue.Savable(now, machine_id, info)) {
+        rescue.GaveUp();
+        return;
+    }
+    SetTaskPriority(task_id, HIGH_PRIORITY);
+    SIM_LOG(3, "Rescuing task ", task_id, " on machine ", machine_id);
+    rescue.Rescued(task_id, info.target_completion);
+    dvfs.Warned(machine_id, task_records[task_id].pace);
+    AdjustPerformance(now, machine_id);
+}
+
+/**
+ * Move the stalled waiting tasks of a CPU type in the order they stalled, up to the first that
+ * still finds no room. Called where cores or memory free up on that type. A task that stopped
+ * waiting meanwhile is checked again at the next check.
+ */
+void Scheduler::RetryStalled(Time_t now, CPUType_t cpu) {
+    for (TaskId_t task_id = rescue.NextStalled(cpu); task_id != TaskId_t(-1); task_id = rescue.NextStalled(cpu)) {
+        if (IsWaiting(task_id)) {
+            if (MoveWaitingTask(now, task_id) == MachineId_t(-1)) {
+                break;
+            }
+            rescue.Moved();
+        }
+        rescue.Watch(now, task_id);
+    }
+}
+
+// The cores a group of machines is asked for: its tasks, placed or waiting for a machine
+unsigned Scheduler::Demand(CPUType_t cpu, bool gpus) const {
+    return index.BusyCores(cpu, gpus) + unplaced_demand[unsigned(cpu) * 2 + gpus];
+}
 
 void Scheduler::PeriodicCheck(Time_t now) {
     // This method should be called from SchedulerCheck()
     // SchedulerCheck is called periodically by the simulator to allow you to monitor, make decisions, adjustments, etc.
     // Unlike the other invocations of the scheduler, this one doesn't report any specific event
     // Recommendation: Take advantage of this function to do some monitoring and adjustments as necessary
-    for (unsigned i = 0; i < active_machines; ++i) {
-        MachineInfo_t info = Machine_GetInfo(machines[i]);
-        if (info.memory_used == 0 && info.active_vms == 0 && info.s_state != S5 && !stateChange[machines[i]]) {
-            // Turn off the machine
-            SimOutput("Turning off machine : " + to_string(machines[i]) + " at time : " + to_string(now), 3);
-            Machine_SetState(machines[i], S5);
-            stateChange[machines[i]] = true;
+    power.Tick(now);
+
+    // Start waking machines up when the demand forecast runs ahead of the cores that are up
+    for (unsigned cpu = 0; cpu < CPU_TYPES; cpu++) {
+        for (bool gpus : {false, true}) {
+            unsigned target = power.TargetCores(CPUType_t(cpu), gpus, Demand(CPUType_t(cpu), gpus));
+            while (index.UpCores(CPUType_t(cpu), gpus) < target) {
+                MachineId_t machine_id = index.FindAsleep(CPUType_t(cpu), gpus);
+                if (machine_id == MachineId_t(-1)) {
+                    break;
+                }
+                SIM_LOG(3, "Waking machine ", machine_id, " ahead of demand at time ", now);
+                SetMachineState(now, machine_id, S0, true);
+            }
+        }
+    }
+
+    // Only the tasks due for a check are visited
+    fill(no_room, no_room + CPU_TYPES, UINT_MAX);
+    rescue.Due(now, due);
+    for (TaskId_t task_id : due) {
+        CheckTask(now, task_id);
+    }
+    // Rescues that missed their target completion stop competing with tasks that can still make theirs
+    rescue.Expired(now, due);
+    for (TaskId_t task_id : due) {
+        if (!IsTaskCompleted(task_id)) {
+            SetTaskPriority(task_id, task_priority(*this, task_id));
+        }
+    }
+
+    Consolidate(now);
+    TelemetrySample(now, index);
+
+    // Machines fenced since the last check, then those where room freed up
+    for (MachineId_t machine_id : overcommitted) {
+        if (!stateChange[machine_id] && index.Get(machine_id).fenced) {
+            EvictVMs(now, machine_id);
+        }
+    }
+    overcommitted.clear();
+    RetryEvictions(now);
+
+    RetireIdleVMs(now);
+
+    // Only machines that are up and empty are visited, the index keeps that set current.
+    // Those the forecast still needs wait in the warm pool, the others are turned off.
+    // Machines still waking up do not count yet, they may be minutes away.
+    // Those of a group whose forecast has nothing to go by yet stay up.
+    // Changing state unlists a machine, so walk a copy.
+    unsigned pooled[CPU_TYPES * 2] = {};
+    vector<MachineId_t> idle(index.Idle().begin(), index.Idle().end());
+    for (MachineId_t machine_id : idle) {
+        if (stateChange[machine_id]) {
+            continue;
+        }
+        const MachineSlot_t & slot = index.Get(machine_id);
+        if (!power.Calibrated(now, slot.cpu, slot.gpus)) {
+            continue;
+        }
+        unsigned target = power.TargetCores(slot.cpu, slot.gpus, Demand(slot.cpu, slot.gpus));
+        MachineState_t s_state = S5;
+        unsigned ready = index.UpCores(slot.cpu, slot.gpus) - power.WakingCores(slot.cpu, slot.gpus);
+        if (ready < target + slot.num_cpus) {
+            unsigned & group_pooled = pooled[unsigned(slot.cpu) * 2 + slot.gpus];
+            s_state = power.PoolState(slot.cpu, slot.gpus, group_pooled);
+            group_pooled += slot.num_cpus;
+        }
+        if (s_state != slot.s_state) {
+            SIM_LOG(3, "Moving machine ", machine_id, " to state ", s_state, " at time : ", now);
+            SetMachineState(now, machine_id, s_state);
         }
     }
 }
@@ -171,61 +829,141 @@ void Scheduler::Shutdown(Time_t time) {
     // Report about the total energy consumed
     // Report about the SLA compliance
     // Shutdown everything to be tidy :-)
-    SimOutput("SimulationComplete(): Initiating shutdown...", 3);
-    for(const auto & vm: vms) {
-        VM_Shutdown(vm);
+    SIM_LOG(3, "SimulationComplete(): Initiating shutdown...");
+    TelemetrySample(time, index, true);
+    for (const vector<VMId_t> & machine_vms : vms_per_machine) {
+        for (VMId_t vm_id : machine_vms) {
+            VM_Shutdown(vm_id);
+        }
     }
-    SimOutput("SimulationComplete(): Finished!", 3);
-    SimOutput("SimulationComplete(): Time is " + to_string(time), 3);
+    power.Report(time);
+    consolidator.Report();
+    rescue.Report();
+    pool.Report();
+    cout << "Memory warnings: " << memory_warnings << ", VMs evicted: " << evicted
+         << ", tasks evicted: " << evicted_tasks << endl;
+    cout << "Tasks queued for want of a machine: " << queued << endl;
+    SIM_LOG(3, "SimulationComplete(): Finished!");
+    SIM_LOG(3, "SimulationComplete(): Time is ", time);
 }
 
 void Scheduler::TaskComplete(Time_t now, TaskId_t task_id) {
     // Do any bookkeeping necessary for the data structures
     // Decide if a machine is to be turned off, slowed down, or VMs to be migrated according to your policy
     // This is an opportunity to make any adjustments to optimize performance/energy
-    SimOutput("Scheduler::TaskComplete(): Task " + to_string(task_id) + " is complete at " + to_string(now), 4);
-
+    SIM_LOG(4, "Scheduler::TaskComplete(): Task ", task_id, " is complete at ", now);
+    const TaskRecord_t * task = task_records.Find(task_id);
+    if (task == nullptr) {
+        return;
+    }
+    VMRecord_t & record = vm_records[task->vm_id];
+    const MachineSlot_t & slot = index.Get(record.machine_id);
+    bool violated = IsSLAViolation(task_id);
+    power.TaskCompleted(slot.cpu, slot.gpus, now - task->placed, task->start, violated);
+    TelemetryTaskDone(task->sla, violated);
+    record.memory -= task->memory;
+    record.cost -= task->cost;
+    Rank(task->vm_id);
+    // Order of the active tasks does not matter, swap the completed one out
+    SwapOut(record.active_tasks, task->position, &TaskRecord_t::position);
+    if (record.active_tasks.empty()) {
+        pool.Idle(now, task->vm_id);
+    }
+    index.RemoveTask(record.machine_id);
+    ReleaseMemory(record.machine_id, task->memory);
+    dvfs.Remove(record.machine_id, task->pace);
+    task_records.Erase(task_id);
+    rescue.TaskDone(now, task_id);
+    AdjustPerformance(now, record.machine_id);
+    RetryStalled(now, record.cpu);
 }
 
 void Scheduler::HandleWarning(Time_t now, TaskId_t task_id) {
-    vector<MachineId_t> sorted = machines;
-    sort(sorted.begin(), sorted.end(), compareMachines);
+    // Run the machine of a task about to miss its SLA at full speed until the task is done.
+    // The simulator only warns once the task is late, tasks at risk are found by CheckTask().
+    TaskRecord_t * task = task_records.Find(task_id);
+    if (task == nullptr) {
+        return;
+    }
+    MachineId_t machine_id = vm_records[task->vm_id].machine_id;
+    dvfs.Warned(machine_id, task->pace);
+    AdjustPerformance(now, machine_id);
+}
+
+/**
+ * Respond to the simulator finding a machine overcommitted: the machine takes no new placements
+ * until its memory is back under the high-water mark. The warning arrives from inside the
+ * simulator calls that add tasks or shut VMs down, so VMs are moved off a newly fenced machine
+ * at the next periodic check rather than here, later warnings for it change nothing.
+ */
+void Scheduler::HandleMemoryWarning(Time_t now, MachineId_t machine_id) {
+    memory_warnings++;
+    if (!index.Get(machine_id).fenced) {
+        SIM_LOG(3, "Fencing overcommitted machine ", machine_id, " at time ", now);
+        index.SetFenced(machine_id, true);
+        index.SetListed(machine_id, false);
+        overcommitted.push_back(machine_id);
+    }
 }
 
 // Public interface below
 
-static Scheduler Scheduler;
+static SelectedPolicy Scheduler;
 
 void InitScheduler() {
-    SimOutput("InitScheduler(): Initializing scheduler", 4);
+    LogInit();
+    ProfileInit();
+    TuningInit();
+    TelemetryInit();
+    SIM_LOG(4, "InitScheduler(): Initializing scheduler");
     Scheduler.Init();
 }
 
 void HandleNewTask(Time_t time, TaskId_t task_id) {
-    SimOutput("HandleNewTask(): Received new task " + to_string(task_id) + " at time " + to_string(time), 4);
-    Scheduler.NewTask(time, task_id);
+    SIM_LOG(4, "HandleNewTask(): Received new task ", task_id, " at time ", time);
+    // Arrivals in the same slot share one event, pick up the ones folded into this one
+    static vector<TaskId_t> batch;
+    Arrivals_TakeBatch(time, task_id, batch);
+    Workload_Stream(time, unsigned(batch.size()));
+    if (batch.size() == 1) {
+        SIM_PROFILE_SCOPE(PROFILE_NEW_TASK);
+        Scheduler.NewTask(time, task_id);
+    } else {
+        HandleNewTasks(time, batch);
+    }
+}
+
+void HandleNewTasks(Time_t time, const vector<TaskId_t> & task_ids) {
+    SIM_PROFILE_SCOPE(PROFILE_NEW_TASKS);
+    SIM_LOG(4, "HandleNewTasks(): Received ", task_ids.size(), " new tasks at time ", time);
+    Scheduler.NewTasks(time, task_ids);
 }
 
 void HandleTaskCompletion(Time_t time, TaskId_t task_id) {
-    SimOutput("HandleTaskCompletion(): Task " + to_string(task_id) + " completed at time " + to_string(time), 4);
+    SIM_PROFILE_SCOPE(PROFILE_TASK_COMPLETE);
+    SIM_LOG(4, "HandleTaskCompletion(): Task ", task_id, " completed at time ", time);
     Scheduler.TaskComplete(time, task_id);
 }
 
 void MemoryWarning(Time_t time, MachineId_t machine_id) {
     // The simulator is alerting you that machine identified by machine_id is overcommitted
-    SimOutput("MemoryWarning(): Overflow at " + to_string(machine_id) + " was detected at time " + to_string(time), 0);
+    SIM_PROFILE_SCOPE(PROFILE_MEMORY_WARNING);
+    SIM_LOG(0, "MemoryWarning(): Overflow at ", machine_id, " was detected at time ", time);
+    Scheduler.HandleMemoryWarning(time, machine_id);
 }
 
 void MigrationDone(Time_t time, VMId_t vm_id) {
     // The function is called on to alert you that migration is complete
-    SimOutput("MigrationDone(): Migration of VM " + to_string(vm_id) + " was completed at time " + to_string(time), 4);
+    SIM_PROFILE_SCOPE(PROFILE_MIGRATION_COMPLETE);
+    SIM_LOG(4, "MigrationDone(): Migration of VM ", vm_id, " was completed at time ", time);
     Scheduler.MigrationComplete(time, vm_id);
-    migration[vm_id] = false;
 }
 
 void SchedulerCheck(Time_t time) {
     // This function is called periodically by the simulator, no specific event
-    SimOutput("SchedulerCheck(): SchedulerCheck() called at " + to_string(time), 4);
+    SIM_PROFILE_SCOPE(PROFILE_PERIODIC_CHECK);
+    SIM_LOG(4, "SchedulerCheck(): SchedulerCheck() called at ", time);
+    ForkPoint(time);
     Scheduler.PeriodicCheck(time);
 }
 
@@ -237,17 +975,23 @@ void SimulationComplete(Time_t time) {
     cout << "SLA2: " << GetSLAReport(SLA2) << "%" << endl;     // SLA3 do not have SLA violation issues
     cout << "Total Energy " << Machine_GetClusterEnergy() << "KW-Hour" << endl;
     cout << "Simulation run finished in " << double(time)/1000000 << " seconds" << endl;
-    SimOutput("SimulationComplete(): Simulation finished at time " + to_string(time), 4);
+    SIM_LOG(4, "SimulationComplete(): Simulation finished at time ", time);
     
     Scheduler.Shutdown(time);
+    ProfileReport();
+    TelemetryShutdown();
+    ForkWait();
+    LogShutdown();
 }
 
 void SLAWarning(Time_t time, TaskId_t task_id) {
-    SimOutput("SLAWarning(): Task " + to_string(task_id) + " experiencing SLA Warning at time " + to_string(time), 4);
+    SIM_PROFILE_SCOPE(PROFILE_SLA_WARNING);
+    SIM_LOG(4, "SLAWarning(): Task ", task_id, " experiencing SLA Warning at time ", time);
     Scheduler.HandleWarning(time, task_id);
 }
 
 void StateChangeComplete(Time_t time, MachineId_t machine_id) {
     // Called in response to an earlier request to change the state of a machinE
+    SIM_PROFILE_SCOPE(PROFILE_STATE_CHANGE);
     Scheduler.HandleStateChange(time, machine_id);
 }
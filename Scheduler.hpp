@@ -8,39 +8,125 @@
 #ifndef Scheduler_hpp
 #define Scheduler_hpp
 
+#include <climits>
+#include <deque>
 #include <vector>
-#include <map>
+#include <set>
 #include <algorithm>
 
+#include "CapacityIndex.hpp"
+#include "Consolidation.hpp"
+#include "DVFS.hpp"
 #include "Interfaces.h"
+#include "Placement.hpp"
+#include "PowerManager.hpp"
+#include "SLARescue.hpp"
+#include "SlotTable.hpp"
+#include "VMPool.hpp"
 
+typedef struct {
+    VMType_t vm_type;
+    CPUType_t cpu;
+    MachineId_t machine_id;                 // The machine hosting the VM
+    MachineId_t target;                     // The machine the VM is migrating to, if migrating
+    unsigned memory;                        // VM overhead plus the memory of its active tasks
+    unsigned reserved;                      // Memory reserved at the target when the migration started
+    unsigned cost;                          // Cost of evicting the VM, its active tasks weighted by SLA
+    double rank;                            // Cost per megabyte, its key in the eviction order of its machine
+    bool migrating;                         // True from VM_Migrate() until the migration completes
+    vector<TaskId_t> active_tasks;
+} VMRecord_t;
+
+// Position of a task that is not waiting in pendingTasks
+#define NOT_WAITING UINT_MAX
+
+typedef struct {
+    VMId_t vm_id;
+    unsigned position;                      // Index of the task in active_tasks of its VM
+    unsigned waiting;                       // Index of the task in pendingTasks of its VM, or NOT_WAITING
+    unsigned memory;
+    unsigned cost;                          // Share of the VM eviction cost, higher for a tighter SLA
+    SLAType_t sla;
+    Time_t placed;                          // When the scheduler placed the task
+    StartKind_t start;                      // Whether the task had to wait for its machine to wake up
+    TaskPace_t pace;                        // Counted in the DVFS load of the machine the task is on
+} TaskRecord_t;
+
+// The mechanics every scheduling policy shares: bookkeeping of machines, VMs and tasks,
+// placing tasks, waking machines up or putting them to sleep and migrating VMs to pack load. The callbacks below are the default
+// behavior, policies (see Policy.hpp) hide the ones they want to change.
 class Scheduler {
 public:
     Scheduler()                 {}
     void Init();
     void MigrationComplete(Time_t time, VMId_t vm_id);
     void HandleStateChange(Time_t time, MachineId_t machine_id);
-    void NewTask(Time_t now, TaskId_t task_id);
-    pair<MachineId_t, VMId_t> FindMachine(bool prefer_gpu, unsigned int task_mem, CPUType_t cpu, VMType_t vm_type);
+    pair<MachineId_t, VMId_t> FindMachine(const TaskInfo_t & info, bool prefer_gpu, unsigned int task_mem, CPUType_t cpu, VMType_t vm_type);
     void PeriodicCheck(Time_t now);
     void Shutdown(Time_t now);
     void TaskComplete(Time_t now, TaskId_t task_id);
     void HandleWarning(Time_t now, TaskId_t task_id);
-private:
-    vector<VMId_t> vms;
+    void HandleMemoryWarning(Time_t now, MachineId_t machine_id);
+    Priority_t TaskPriority(TaskId_t task_id);
+    VMId_t FindVM(MachineId_t machine_id, VMType_t vm_type, CPUType_t cpu);
+protected:
+    void MigrateVM(VMId_t vm_id, MachineId_t machine_id);
+    void PlaceTask(const TaskInfo_t & info, MachineId_t machine_id, VMId_t vm_id, Priority_t priority);
+    void SetMachineState(Time_t now, MachineId_t machine_id, MachineState_t s_state, bool ahead = false);
+    void AdjustPerformance(Time_t now, MachineId_t machine_id);
+    void Consolidate(Time_t now);
+    void ShutdownVM(VMId_t vm_id);
+    void RetireIdleVMs(Time_t now);
+    void ReleaseMemory(MachineId_t machine_id, unsigned memory);
+    bool EvictVMs(Time_t now, MachineId_t machine_id);
+    void RetryEvictions(Time_t now);
+    void Rank(VMId_t vm_id);
+    void Unrank(VMId_t vm_id);
+    bool IsWaiting(TaskId_t task_id);
+    void SwapOut(vector<TaskId_t> & tasks, unsigned position, unsigned TaskRecord_t::* field);
+    MachineId_t MoveWaitingTask(Time_t now, TaskId_t task_id);
+    void CheckTask(Time_t now, TaskId_t task_id);
+    void RetryStalled(Time_t now, CPUType_t cpu);
+    unsigned Demand(CPUType_t cpu, bool gpus) const;
+
+    // Hooks of the policy (see Policy.hpp), the scheduler's own paths reach the FindVM and
+    // TaskPriority a policy may hide through them
+    VMId_t (*find_vm)(Scheduler & scheduler, MachineId_t machine_id, VMType_t vm_type, CPUType_t cpu);
+    Priority_t (*task_priority)(Scheduler & scheduler, TaskId_t task_id);
+
+    unsigned active_machines;
     vector<MachineId_t> machines;
-};
+    vector<vector<VMId_t>> vms_per_machine;
+    CapacityIndex index;
+    PowerManager power;
+    PlacementModel placement;
+    DVFSController dvfs;
+    Consolidator consolidator;
+    SLARescue rescue;
+    VMPool pool;
+    SlotTable<VMRecord_t> vm_records;
+    SlotTable<TaskRecord_t> task_records;
 
-bool compareMachines(MachineId_t lhs, MachineId_t rhs) {
-    MachineInfo_t lhsInfo = Machine_GetInfo(lhs);
-    MachineInfo_t rhsInfo = Machine_GetInfo(rhs);
-    return lhsInfo.memory_used < rhsInfo.memory_used;
-}
-
-bool cmpMachinesEnergy(MachineId_t lhs, MachineId_t rhs) {
-    MachineInfo_t lhsInfo = Machine_GetInfo(lhs);
-    MachineInfo_t rhsInfo = Machine_GetInfo(rhs);
-    return lhsInfo.energy_consumed < rhsInfo.energy_consumed;
-}
+    vector<bool> stateChange;
+    SlotTable<vector<TaskId_t>> pendingTasks;
+    vector<vector<VMId_t>> pendingVMs;
+    deque<TaskId_t> unplaced[CPU_TYPES];    // Tasks no machine could take yet, by CPU type
+    unsigned unplaced_demand[CPU_TYPES * 2];// The same counted by CPU type and GPU flavor asked for
+    unsigned queued;                        // Tasks that ever waited in unplaced
+    unsigned memory_warnings;
+    unsigned evicted;
+    unsigned evicted_tasks;                 // Waiting tasks moved off an overcommitted machine on their own
+    vector<set<pair<double, VMId_t>>> evictable;// VMs of each machine not migrating, cheapest to evict first
+    vector<unsigned> leaving;               // Memory of the VMs migrating off each machine
+    bool freed[CPU_TYPES];                  // Memory freed up on the CPU type since the last check
+private:
+    vector<MachineId_t> donors;             // Scratch lists for Consolidate()
+    vector<pair<VMId_t, MachineId_t>> plan;
+    vector<MachineId_t> overcommitted;      // Machines fenced since the last check
+    vector<TaskId_t> moving;                // Scratch list for EvictVMs()
+    vector<TaskId_t> due;                   // Scratch lists for PeriodicCheck()
+    vector<VMId_t> retiring;
+    unsigned no_room[CPU_TYPES];            // Smallest waiting task memory no machine had room for
+};
 
 #endif /* Scheduler_hpp */
@@ -43,6 +43,7 @@ typedef enum {
     RISCV,
     X86
 } CPUType_t;
+#define CPU_TYPES 4
 
 typedef enum {
     S0,         // Machine is up. CPU's are at state C0 if running a task or C1
@@ -84,6 +85,7 @@ typedef enum {
     WIN,
     AIX
 } VMType_t;
+#define VM_TYPES 4
 #define VM_MEMORY_OVERHEAD  8 
 
 typedef struct {
@@ -132,4 +134,16 @@ typedef struct {
     MachineId_t machine_id;                 // The identifier of the machine
 } MachineInfo_t;
 
+// The parts of MachineInfo_t that never change after Machine_Add, shared by all machines of a class
+typedef struct {
+    unsigned num_cpus;                      // Number of CPU's on the machine
+    CPUType_t cpu;                          // CPU types deployed in the machine
+    unsigned memory_size;                   // Size of memory
+    bool gpus;                              // True if the processors are equipped with a GPU, false otherwise
+    vector<unsigned> performance;           // The MIPS ratings for the CPUs at different p-state
+    vector<unsigned> c_states;              // Power consumption under different C states
+    vector<unsigned> p_states;              // Power consumption for cores at different P states. Valid only when C-state is C0.
+    vector<unsigned> s_states;              // Machine power consumption under different S states
+} MachineClass_t;
+
 #endif /* SimTypes_h */
@@ -0,0 +1,71 @@
+//
+//  SlotTable.hpp
+//  CloudSim
+//
+
+#ifndef SlotTable_hpp
+#define SlotTable_hpp
+
+#include <climits>
+#include <vector>
+
+#include "SimTypes.h"
+
+// Records keyed by the dense integer ids the simulator hands out (tasks, VMs), kept in one
+// contiguous array. An id maps to its slot through a flat array, so a lookup is two loads
+// instead of a tree walk, and the slot of an erased record goes back on a free list for the
+// next id. Ids are never reused by the simulator but slots are, so the records take space
+// for the ids alive at once, not for every id ever seen; only the id to slot array grows
+// with the ids, at four bytes each.
+template <class T>
+class SlotTable {
+public:
+    SlotTable()                 {}
+    bool Contains(unsigned id) const { return id < slot_of.size() && slot_of[id] != NO_SLOT; }
+    T * Find(unsigned id)       { return Contains(id) ? &records[slot_of[id]] : nullptr; }
+    const T * Find(unsigned id) const { return Contains(id) ? &records[slot_of[id]] : nullptr; }
+    T & operator[](unsigned id) { return records[slot_of[id]]; }
+    const T & operator[](unsigned id) const { return records[slot_of[id]]; }
+    unsigned Size() const       { return unsigned(records.size() - free_slots.size()); }
+
+    T & Insert(unsigned id);
+    void Erase(unsigned id);
+private:
+    static constexpr unsigned NO_SLOT = UINT_MAX;
+
+    vector<T> records;
+    vector<unsigned> slot_of;               // Slot of each id, NO_SLOT if the id has no record
+    vector<unsigned> free_slots;
+};
+
+/**
+ * The record of an id, taking a slot for it if it has none. A recycled slot keeps what its
+ * last record held, so containers in it keep their capacity: the caller sets every field.
+ */
+template <class T>
+T & SlotTable<T>::Insert(unsigned id) {
+    if (Contains(id)) {
+        return records[slot_of[id]];
+    }
+    if (id >= slot_of.size()) {
+        slot_of.resize(max(size_t(id) + 1, slot_of.size() * 2), NO_SLOT);
+    }
+    if (free_slots.empty()) {
+        slot_of[id] = unsigned(records.size());
+        records.emplace_back();
+    } else {
+        slot_of[id] = free_slots.back();
+        free_slots.pop_back();
+    }
+    return records[slot_of[id]];
+}
+
+template <class T>
+void SlotTable<T>::Erase(unsigned id) {
+    if (Contains(id)) {
+        free_slots.push_back(slot_of[id]);
+        slot_of[id] = NO_SLOT;
+    }
+}
+
+#endif /* SlotTable_hpp */
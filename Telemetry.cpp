@@ -0,0 +1,210 @@
+//
+//  Telemetry.cpp
+//  CloudSim
+//
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+
+#include "Telemetry.h"
+
+typedef struct {
+    Time_t time;
+    unsigned class_id;
+    CPUType_t cpu;
+    bool gpus;
+    unsigned num_cpus;
+    unsigned machines[S_STATES];            // Machines of the class in, or heading to, each S-state
+    uint64_t memory_used;
+    uint64_t memory_size;
+    unsigned vms;
+    unsigned tasks;
+    double power;                           // Watts the class draws, estimated from its power tables
+    double cluster_power;                   // Watts the cluster drew on average since the previous sample
+    double cluster_energy;                  // KW-Hour
+    unsigned completed;
+    unsigned violations[SLA3];              // SLA0 to SLA2
+} Row_t;
+
+// Ring of rows between the event loop and the writer thread. The event loop only copies a row
+// into the next free slot, the writer formats and writes out whatever has been filled since
+// it last woke. Should the writer ever fall a whole ring behind, the event loop waits for it
+// rather than lose rows.
+class TelemetrySink {
+public:
+    TelemetrySink(FILE * out) : out(out), ring(RING_ROWS), head(0), tail(0), done(false) {
+        fprintf(out, "time_s,class,cpu,gpus,cores,s0,s0i1,s1,s2,s3,s4,s5,memory_utilization,vms,tasks,power_w,"
+                     "cluster_power_w,cluster_energy_kwh,completed,sla0_violations,sla1_violations,sla2_violations\n");
+        writer = thread(&TelemetrySink::Run, this);
+    }
+    ~TelemetrySink() {
+        {
+            lock_guard<mutex> lock(m);
+            done = true;
+        }
+        wake.notify_one();
+        writer.join();
+        fclose(out);
+    }
+    void Push(const Row_t & row) {
+        size_t h = head.load(memory_order_relaxed);
+        if (h - tail.load(memory_order_acquire) == RING_ROWS) {
+            unique_lock<mutex> lock(m);
+            wake.notify_one();
+            space.wait(lock, [this, h] { return h - tail.load(memory_order_acquire) < RING_ROWS; });
+        }
+        ring[h % RING_ROWS] = row;
+        head.store(h + 1, memory_order_release);
+    }
+private:
+    static const size_t RING_ROWS = 1 << 14;
+
+    void Run() {
+        while (true) {
+            bool stop;
+            {
+                unique_lock<mutex> lock(m);
+                wake.wait_for(lock, chrono::milliseconds(100), [this] { return done; });
+                stop = done;
+            }
+            size_t end = head.load(memory_order_acquire);
+            for (size_t t = tail.load(memory_order_relaxed); t < end; t++) {
+                Write(ring[t % RING_ROWS]);
+            }
+            {
+                lock_guard<mutex> lock(m);
+                tail.store(end, memory_order_release);
+            }
+            space.notify_one();
+            if (stop) {
+                break;
+            }
+        }
+        fflush(out);
+    }
+
+    void Write(const Row_t & row) {
+        static const char * cpus[] = {"ARM", "POWER", "RISCV", "X86"};
+        fprintf(out, "%.6f,%u,%s,%s,%u", double(row.time) / 1000000, row.class_id, cpus[row.cpu], row.gpus ? "yes" : "no", row.num_cpus);
+        for (unsigned s = 0; s < S_STATES; s++) {
+            fprintf(out, ",%u", row.machines[s]);
+        }
+        fprintf(out, ",%.4f,%u,%u,%.1f,%.1f,%.9g,%u,%u,%u,%u\n",
+                row.memory_size > 0 ? double(row.memory_used) / row.memory_size : 0.0, row.vms, row.tasks,
+                row.power, row.cluster_power, row.cluster_energy, row.completed, row.violations[SLA0], row.violations[SLA1], row.violations[SLA2]);
+    }
+
+    FILE * out;
+    vector<Row_t> ring;
+    atomic<size_t> head;                    // Rows pushed so far, only the event loop writes it
+    atomic<size_t> tail;                    // Rows written out so far, only the writer writes it
+    mutex m;
+    condition_variable wake;
+    condition_variable space;
+    thread writer;
+    bool done;
+};
+
+static TelemetrySink * sink = nullptr;
+static Time_t interval = 60000000;
+static Time_t next_sample = 0;
+static Time_t last_sample = 0;
+static double last_energy = 0.0;            // Cluster energy at the previous sample
+static vector<Row_t> rows;                  // Scratch rows, one per machine class
+static unsigned completed = 0;
+static unsigned violations[SLA3] = {};
+
+void TelemetryInit() {
+    const char * path = getenv("SIM_TELEMETRY");
+    if (path == nullptr || sink != nullptr) {
+        return;
+    }
+    FILE * out = fopen(path, "w");
+    if (out == nullptr) {
+        ThrowException("TelemetryInit(): Unable to open telemetry file ", string(path));
+    }
+    const char * seconds = getenv("SIM_TELEMETRY_INTERVAL");
+    if (seconds != nullptr) {
+        interval = max(Time_t(atof(seconds) * 1000000), Time_t(1));
+    }
+    sink = new TelemetrySink(out);
+}
+
+void TelemetryShutdown() {
+    delete sink;
+    sink = nullptr;
+}
+
+/**
+ * The power a machine draws in its current state. An S0 machine draws its S0 power plus, for
+ * each core, the power of the P-state if a task runs on it and of C1 if not; asleep, it draws
+ * the power of its S-state.
+ */
+static double Power(const MachineSlot_t & slot, const MachineClass_t & machine_class) {
+    if (machine_class.s_states.size() != S_STATES) {
+        return 0.0;
+    }
+    double power = machine_class.s_states[slot.s_state];
+    if (slot.s_state == S0 && machine_class.p_states.size() == P_STATES && machine_class.c_states.size() > C1) {
+        unsigned busy = min(slot.active_tasks, slot.num_cpus);
+        power += double(busy) * machine_class.p_states[slot.p_state] + double(slot.num_cpus - busy) * machine_class.c_states[C1];
+    }
+    return power;
+}
+
+/**
+ * Take a sample if one is due. Visits every machine, reading only the scheduler's own
+ * bookkeeping, and asks the simulator for the cluster energy once.
+ * @param last true to take a sample whether or not one is due, at the end of the simulation
+ */
+void TelemetrySample(Time_t now, const CapacityIndex & index, bool last) {
+    if (sink == nullptr || (now < next_sample && !last)) {
+        return;
+    }
+    next_sample = now + interval;
+    rows.assign(index.NumClasses(), Row_t{});
+    for (unsigned i = 0; i < index.Size(); i++) {
+        const MachineSlot_t & slot = index.Get(MachineId_t(i));
+        Row_t & row = rows[slot.class_id];
+        row.machines[slot.s_state]++;
+        row.memory_used += slot.memory_used;
+        row.memory_size += slot.memory_size;
+        row.vms += slot.active_vms;
+        row.tasks += slot.active_tasks;
+        row.power += Power(slot, index.Class(slot.class_id));
+    }
+
+    double cluster_energy = Machine_GetClusterEnergy();
+    // Kilowatt-hours to watt-microseconds, over microseconds
+    double cluster_power = now > last_sample ? (cluster_energy - last_energy) * 3.6e12 / double(now - last_sample) : 0.0;
+    for (unsigned c = 0; c < rows.size(); c++) {
+        Row_t & row = rows[c];
+        const MachineClass_t & machine_class = index.Class(c);
+        row.time = now;
+        row.class_id = c;
+        row.cpu = machine_class.cpu;
+        row.gpus = machine_class.gpus;
+        row.num_cpus = machine_class.num_cpus;
+        row.cluster_power = cluster_power;
+        row.cluster_energy = cluster_energy;
+        row.completed = completed;
+        for (unsigned s = SLA0; s < SLA3; s++) {
+            row.violations[s] = violations[s];
+        }
+        sink->Push(row);
+    }
+    last_sample = now;
+    last_energy = cluster_energy;
+}
+
+void TelemetryTaskDone(SLAType_t sla, bool violated) {
+    completed++;
+    if (violated && sla < SLA3) {
+        violations[sla]++;
+    }
+}
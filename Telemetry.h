@@ -0,0 +1,25 @@
+//
+//  Telemetry.h
+//  CloudSim
+//
+
+#ifndef Telemetry_h
+#define Telemetry_h
+
+// Time series of the cluster while it runs. Setting SIM_TELEMETRY=path samples every machine
+// class each SIM_TELEMETRY_INTERVAL simulated seconds (60 by default): machines in each
+// S-state, memory utilization, active VMs and tasks and the power drawn, estimated from the
+// power tables of the class. Each sample also carries the average power the cluster drew
+// since the previous one by the simulator's energy counter, the cluster energy and the
+// running count of completed tasks and SLA violations. A sample only copies numbers into a
+// preallocated ring buffer; a background writer turns the rows into CSV, one row per class
+// and sample.
+
+#include "CapacityIndex.hpp"
+
+extern void TelemetryInit();
+extern void TelemetryShutdown();
+extern void TelemetrySample(Time_t now, const CapacityIndex & index, bool last = false);
+extern void TelemetryTaskDone(SLAType_t sla, bool violated);
+
+#endif /* Telemetry_h */
@@ -0,0 +1,162 @@
+//
+//  Tuning.cpp
+//  CloudSim
+//
+//  The simulator keeps its state in the prebuilt objects, where it cannot be written out, so
+//  a what-if run is a fork() of the whole process: the child starts from a copy-on-write image
+//  of every machine, VM, task and pending event as well as the scheduler's own bookkeeping.
+//
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sstream>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "Tuning.h"
+#include "Logging.h"
+#include "Telemetry.h"
+
+Tuning_t tuning = {0.9, 4.0, 8, 0.8, 100000, 10000000};
+
+typedef struct {
+    const char * name;
+    double * value;
+} Knob_t;
+
+static const Knob_t knobs[] = {
+    {"memory_high_water", &tuning.memory_high_water},
+    {"migration_payback", &tuning.migration_payback},
+    {"max_migrations", &tuning.max_migrations},
+    {"slack_margin", &tuning.slack_margin},
+    {"min_check_interval", &tuning.min_check_interval},
+    {"vm_idle_time", &tuning.vm_idle_time},
+};
+
+typedef struct {
+    string name;
+    string settings;                        // "name=value,..." applied by the fork
+} Fork_t;
+
+static Time_t fork_at = Time_t(-1);
+static vector<Fork_t> forks;
+static vector<pid_t> children;
+
+// Applies "name=value,..." to the knobs
+static void Apply(const string & settings) {
+    stringstream in(settings);
+    string setting;
+    while (getline(in, setting, ',')) {
+        if (setting.empty()) {
+            continue;
+        }
+        size_t eq = setting.find('=');
+        const Knob_t * knob = nullptr;
+        for (const Knob_t & k : knobs) {
+            if (eq != string::npos && setting.compare(0, eq, k.name) == 0 && strlen(k.name) == eq) {
+                knob = &k;
+            }
+        }
+        if (knob == nullptr) {
+            ThrowException("TuningInit(): Unknown setting ", setting);
+        }
+        *knob->value = atof(setting.c_str() + eq + 1);
+    }
+}
+
+void TuningInit() {
+    const char * tune = getenv("SIM_TUNE");
+    if (tune != nullptr) {
+        Apply(tune);
+    }
+    const char * at = getenv("SIM_FORK_AT");
+    const char * list = getenv("SIM_FORKS");
+    if (at == nullptr || list == nullptr) {
+        return;
+    }
+    fork_at = Time_t(atof(at) * 1000000);
+    Tuning_t base = tuning;
+    stringstream in(list);
+    string entry;
+    while (getline(in, entry, ';')) {
+        if (entry.empty()) {
+            continue;
+        }
+        size_t colon = entry.find(':');
+        forks.push_back({entry.substr(0, colon), colon == string::npos ? "" : entry.substr(colon + 1)});
+        Apply(forks.back().settings);       // Fail on a bad setting now rather than at the fork point
+    }
+    // The base run keeps the settings it started with
+    tuning = base;
+}
+
+// Each fork writes its log and telemetry to files of its own, named after it
+static void Reopen(const string & name) {
+    for (const char * env : {"SIM_LOG_FILE", "SIM_TELEMETRY"}) {
+        const char * path = getenv(env);
+        if (path != nullptr) {
+            setenv(env, (string(path) + "." + name).c_str(), 1);
+        }
+    }
+    LogInit();
+    TelemetryInit();
+}
+
+/**
+ * Fork the run once the simulation reaches the fork point. Called from every periodic check,
+ * it does nothing before the fork point and after the forks.
+ */
+void ForkPoint(Time_t now) {
+    if (now < fork_at || forks.empty()) {
+        return;
+    }
+    fork_at = Time_t(-1);
+    const char * out = getenv("SIM_FORK_OUT");
+    const string prefix = out == nullptr ? "fork" : out;
+
+    // Nothing buffered before the forks may be written twice, and the log and telemetry
+    // writer threads do not survive a fork
+    cout.flush();
+    fflush(stdout);
+    LogShutdown();
+    TelemetryShutdown();
+    SIM_LOG(1, "Forking ", unsigned(forks.size()), " what-if runs at time ", now);
+
+    for (const Fork_t & entry : forks) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            ThrowException("ForkPoint(): Unable to fork ", entry.name);
+        }
+        if (pid == 0) {
+            string path = prefix + "." + entry.name + ".txt";
+            int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (fd < 0) {
+                ThrowException("ForkPoint(): Unable to open the output of ", path);
+            }
+            dup2(fd, STDOUT_FILENO);
+            close(fd);
+            Reopen(entry.name);
+            Apply(entry.settings);
+            cout << "Fork " << entry.name << " from time " << now << ": " << entry.settings << endl;
+            children.clear();               // The forks made before this one are its siblings
+            forks.clear();
+            return;
+        }
+        children.push_back(pid);
+    }
+    Reopen("base");
+}
+
+// The base run waits for the forks, so the run is over when the process exits
+void ForkWait() {
+    for (pid_t pid : children) {
+        int status;
+        waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            cout << "Fork process " << pid << " failed" << endl;
+        }
+    }
+    children.clear();
+}
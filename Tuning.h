@@ -0,0 +1,44 @@
+//
+//  Tuning.h
+//  CloudSim
+//
+
+#ifndef Tuning_h
+#define Tuning_h
+
+// Scheduler tuning and forked what-if runs. The thresholds the scheduler tunes by are kept in
+// `tuning` rather than compiled in, SIM_TUNE="name=value,..." sets them for a whole run.
+// Setting SIM_FORK_AT to a simulated time in seconds and SIM_FORKS to a list of named
+// settings forks the run there:
+//
+//     SIM_FORK_AT=1800 SIM_FORKS="tight:memory_high_water=0.8;lazy:migration_payback=8" ./simulator Hour.md
+//
+// At the first periodic check at or after that time the process forks once per entry. Each
+// child holds a copy of the whole simulator and scheduler state at that point, applies its
+// settings and runs to the end with its output in SIM_FORK_OUT.<name>.txt (SIM_FORK_OUT
+// defaults to "fork"). The parent carries on unchanged as the base run and waits for the
+// children before it exits. The shared prefix is simulated once, and the forks run side by
+// side. With SIM_LOG_FILE or SIM_TELEMETRY set, every fork writes to that path suffixed with
+// .<name> from the fork point on, the base run to the one suffixed .base. Nothing is written
+// to disk: the forks only live as long as the run, and all of them use the policy compiled in.
+
+#include <string>
+
+#include "Interfaces.h"
+
+typedef struct {
+    double memory_high_water;               // Share of its memory past which a machine takes no placements
+    double migration_payback;               // How many times longer than the migration a moved VM must run
+    double max_migrations;                  // Consolidation migrations in flight at once
+    double slack_margin;                    // Share of the time to its target a task may take under DVFS
+    double min_check_interval;              // Microseconds between two checks of a watched task
+    double vm_idle_time;                    // Microseconds a VM may stay without a task before it is shut down
+} Tuning_t;
+
+extern Tuning_t tuning;
+
+extern void TuningInit();
+extern void ForkPoint(Time_t now);
+extern void ForkWait();
+
+#endif /* Tuning_h */
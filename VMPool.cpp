@@ -0,0 +1,98 @@
+//
+//  VMPool.cpp
+//  CloudSim
+//
+
+#include <algorithm>
+
+#include "VMPool.hpp"
+
+void VMPool::Init() {
+    created = 0;
+    reused = 0;
+    moved = 0;
+    retired = 0;
+}
+
+/**
+ * The VMs that went idle before a time and are idle still, oldest first.
+ * @param expired cleared and filled with the VM ids
+ */
+void VMPool::Expired(Time_t idle_before, vector<VMId_t> & expired) const {
+    expired.clear();
+    for (auto it = idle.begin(); it != idle.end() && it->first < idle_before; ++it) {
+        expired.push_back(it->second);
+    }
+}
+
+// A VM joins the pool of its machine when it is created
+void VMPool::Add(VMId_t vm_id, MachineId_t machine_id, VMType_t vm_type, CPUType_t cpu) {
+    pools[KeyOf(machine_id, vm_type, cpu)].push_back(vm_id);
+}
+
+// and leaves it, and the idle list, when it is shut down
+void VMPool::Remove(VMId_t vm_id, MachineId_t machine_id, VMType_t vm_type, CPUType_t cpu) {
+    Unlink(vm_id, machine_id, vm_type, cpu);
+    Wake(vm_id);
+}
+
+// A migrated VM changes pools, idle or not
+void VMPool::Move(VMId_t vm_id, MachineId_t source, MachineId_t target, VMType_t vm_type, CPUType_t cpu) {
+    Unlink(vm_id, source, vm_type, cpu);
+    Add(vm_id, target, vm_type, cpu);
+}
+
+void VMPool::Unlink(VMId_t vm_id, MachineId_t machine_id, VMType_t vm_type, CPUType_t cpu) {
+    auto it = pools.find(KeyOf(machine_id, vm_type, cpu));
+    if (it == pools.end()) {
+        return;
+    }
+    vector<VMId_t> & machine_vms = it->second;
+    auto pos = find(machine_vms.begin(), machine_vms.end(), vm_id);
+    if (pos != machine_vms.end()) {
+        *pos = machine_vms.back();
+        machine_vms.pop_back();
+    }
+    if (machine_vms.empty()) {
+        pools.erase(it);
+    }
+}
+
+/**
+ * Record that a task was placed in a VM. Only first placements count towards the reuse of VMs.
+ * @param created true if the VM was created for the task
+ * @param moved true if the task was placed before and moved off its machine
+ */
+void VMPool::Placed(VMId_t vm_id, bool created, bool moved) {
+    if (created) {
+        this->created++;
+    }
+    if (moved) {
+        this->moved++;
+    } else if (!created) {
+        reused++;
+    }
+    Wake(vm_id);
+}
+
+// Record that the last task of a VM has left
+void VMPool::Idle(Time_t now, VMId_t vm_id) {
+    if (!idle_since.Contains(vm_id)) {
+        idle_since.Insert(vm_id) = now;
+        idle.insert({now, vm_id});
+    }
+}
+
+// Takes a VM off the idle list, when it gets a task or is shut down
+void VMPool::Wake(VMId_t vm_id) {
+    const Time_t * since = idle_since.Find(vm_id);
+    if (since != nullptr) {
+        idle.erase({*since, vm_id});
+        idle_since.Erase(vm_id);
+    }
+}
+
+void VMPool::Report() const {
+    cout << "VMs created: " << created << ", tasks placed in an existing VM: " << reused
+         << ", tasks placed again after a move: " << moved << ", idle VMs retired: " << retired << endl;
+}
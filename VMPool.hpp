@@ -0,0 +1,84 @@
+//
+//  VMPool.hpp
+//  CloudSim
+//
+
+#ifndef VMPool_hpp
+#define VMPool_hpp
+
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include "Interfaces.h"
+#include "SlotTable.hpp"
+
+// The VMs on each machine, hashed by machine, VM type and CPU type, so a task finds a VM of
+// its kind on the machine picked for it with one lookup rather than a walk over the machine's
+// VMs, and only gets a VM of its own, with its memory overhead and attach, when there is none
+// with room. The scheduler caps the tasks of a VM so that a VM can always be migrated to an
+// empty machine; the newest VMs of a kind, which are the ones with room, are probed first and
+// those running tasks go before idle ones. A VM is idle from its last task leaving until it gets another; the pool
+// keeps the idle VMs in the order they went idle so the scheduler can retire, in one pass
+// over the oldest, those idle for longer than tuning.vm_idle_time.
+class VMPool {
+public:
+    VMPool()                    {}
+    void Init();
+    template <class Accept>
+    VMId_t Find(MachineId_t machine_id, VMType_t vm_type, CPUType_t cpu, Accept accept) const;
+    void Expired(Time_t idle_before, vector<VMId_t> & expired) const;
+
+    void Add(VMId_t vm_id, MachineId_t machine_id, VMType_t vm_type, CPUType_t cpu);
+    void Remove(VMId_t vm_id, MachineId_t machine_id, VMType_t vm_type, CPUType_t cpu);
+    void Move(VMId_t vm_id, MachineId_t source, MachineId_t target, VMType_t vm_type, CPUType_t cpu);
+    void Placed(VMId_t vm_id, bool created, bool moved);
+    void Idle(Time_t now, VMId_t vm_id);
+    void Retired()              { retired++; }
+    void Report() const;
+private:
+    static uint64_t KeyOf(MachineId_t machine_id, VMType_t vm_type, CPUType_t cpu) {
+        return (uint64_t(machine_id) * VM_TYPES + vm_type) * CPU_TYPES + cpu;
+    }
+    void Unlink(VMId_t vm_id, MachineId_t machine_id, VMType_t vm_type, CPUType_t cpu);
+    void Wake(VMId_t vm_id);
+
+    unordered_map<uint64_t, vector<VMId_t>> pools;
+    SlotTable<Time_t> idle_since;           // When each idle VM went idle
+    set<pair<Time_t, VMId_t>> idle;         // Idle VMs, oldest first
+    unsigned created;
+    unsigned reused;                        // Tasks placed in a VM that was already there
+    unsigned moved;                         // Tasks placed again after moving off their machine
+    unsigned retired;
+};
+
+/**
+ * Find a VM of a kind on a machine with room for a task, one running tasks if there is one.
+ * Only the newest VMs of the kind are probed.
+ * @param accept predicate on the VM id, false if the VM has no room
+ * @returns the VM id, or -1 if no probed VM has room.
+ */
+template <class Accept>
+VMId_t VMPool::Find(MachineId_t machine_id, VMType_t vm_type, CPUType_t cpu, Accept accept) const {
+    const unsigned MAX_PROBES = 4;
+    auto it = pools.find(KeyOf(machine_id, vm_type, cpu));
+    if (it == pools.end()) {
+        return VMId_t(-1);
+    }
+    VMId_t idle_vm = VMId_t(-1);
+    unsigned probes = 0;
+    for (auto vm = it->second.rbegin(); vm != it->second.rend() && probes < MAX_PROBES; ++vm, ++probes) {
+        if (!accept(*vm)) {
+            continue;
+        }
+        if (!idle_since.Contains(*vm)) {
+            return *vm;
+        }
+        if (idle_vm == VMId_t(-1)) {
+            idle_vm = *vm;
+        }
+    }
+    return idle_vm;
+}
+
+#endif /* VMPool_hpp */
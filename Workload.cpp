@@ -0,0 +1,265 @@
+//
+//  Workload.cpp
+//  CloudSim
+//
+//  Hooks the simulator's start-up to compile and load binary workload images (see Workload.h).
+//  Init.o and main.o are prebuilt, so the hooks are attached at link time with --wrap:
+//  Init, Machine_Add, AddTask, GetNumTasks and StartSimulation resolve to the functions below,
+//  which call through to the originals.
+//
+//  The same hooks stream the tasks. Setting SIM_STREAM_AHEAD to a time in microseconds holds
+//  every task the input generates back in a compact record, sorts them by arrival and adds each
+//  to the simulator only once the clock is within that time of its arrival, or when it is the
+//  next arrival and none is pending. The event queue then holds a window of arrivals instead
+//  of the whole trace. Task ids follow arrival order rather than the order of the input, and
+//  the arrivals of the task classes are still generated by Init.o up front. Task.o keeps every
+//  task it was given to the end of the run, so memory still grows with the trace, by less.
+//
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Interfaces.h"
+#include "Internal_Interfaces.h"
+#include "Workload.h"
+
+extern void RealInit(string filename) asm("__real__Z4InitNSt7__cxx1112basic_stringIcSt11char_traitsIcESaIcEEE");
+extern void RealMachineAdd(u_int mem, u_int cores, vector<u_int> & s_states, vector<u_int> & c_states, vector<u_int> & p_states, vector<u_int> & mips, bool gpu, CPUType_t cpu)
+    asm("__real__Z11Machine_AddjjRSt6vectorIjSaIjEES2_S2_S2_b9CPUType_t");
+extern TaskId_t RealAddTask(uint64_t inst, Time_t arr, Time_t trgt, VMType_t vm, SLAType_t sla, CPUType_t cpu, bool gpu, unsigned mem, TaskClass_t task_class)
+    asm("__real__Z7AddTaskmmm8VMType_t9SLAType_t9CPUType_tbj11TaskClass_t");
+extern void RealStartSimulation() asm("__real__Z15StartSimulationv");
+extern unsigned RealGetNumTasks() asm("__real__Z11GetNumTasksv");
+
+void WrapInit(string filename) asm("__wrap__Z4InitNSt7__cxx1112basic_stringIcSt11char_traitsIcESaIcEEE");
+void WrapMachineAdd(u_int mem, u_int cores, vector<u_int> & s_states, vector<u_int> & c_states, vector<u_int> & p_states, vector<u_int> & mips, bool gpu, CPUType_t cpu)
+    asm("__wrap__Z11Machine_AddjjRSt6vectorIjSaIjEES2_S2_S2_b9CPUType_t");
+TaskId_t WrapAddTask(uint64_t inst, Time_t arr, Time_t trgt, VMType_t vm, SLAType_t sla, CPUType_t cpu, bool gpu, unsigned mem, TaskClass_t task_class)
+    asm("__wrap__Z7AddTaskmmm8VMType_t9SLAType_t9CPUType_tbj11TaskClass_t");
+void WrapStartSimulation() asm("__wrap__Z15StartSimulationv");
+unsigned WrapGetNumTasks() asm("__wrap__Z11GetNumTasksv");
+
+// Machines and tasks generated from the text input while compiling. Machine_GetInfo()
+// leaves the S-state table out, so machines are recorded as they are added too.
+static vector<WorkloadMachine_t> compiled_machines;
+static vector<WorkloadTask_t> compiled_tasks;
+
+// The S-state power table of every machine, in machine id order, for the scheduler
+static vector<vector<unsigned>> machine_s_states;
+
+// Tasks held back while streaming, in arrival order once the simulation starts
+static vector<WorkloadTask_t> stream;
+static size_t stream_next = 0;              // First task not yet added
+static size_t stream_total = 0;
+static uint64_t stream_pending = 0;         // Added, arrival not yet delivered
+
+static bool Compiling() {
+    return getenv("SIM_COMPILE") != nullptr;
+}
+
+// An image is compiled from the whole task stream, so compiling does not stream
+static bool Streaming() {
+    return getenv("SIM_STREAM_AHEAD") != nullptr && !Compiling();
+}
+
+static Time_t StreamAhead() {
+    static Time_t ahead = Time_t(-1);
+    if (ahead == Time_t(-1)) {
+        ahead = Time_t(strtoull(getenv("SIM_STREAM_AHEAD"), nullptr, 10));
+    }
+    return ahead;
+}
+
+static void StartStream() {
+    if (!Streaming()) {
+        return;
+    }
+    stable_sort(stream.begin(), stream.end(), [](const WorkloadTask_t & a, const WorkloadTask_t & b) { return a.arrival < b.arrival; });
+    SimOutput("StartStream(): Streaming " + to_string(stream_total) + " tasks", 1);
+    Workload_Stream(0, 0);
+}
+
+static bool IsImage(const string & filename) {
+    char magic[8] = {};
+    FILE * in = fopen(filename.c_str(), "rb");
+    if (in == nullptr) {
+        return false;
+    }
+    size_t n = fread(magic, 1, sizeof(magic), in);
+    fclose(in);
+    return n == sizeof(magic) && memcmp(magic, WORKLOAD_MAGIC, sizeof(magic)) == 0;
+}
+
+static void LoadImage(const string & filename) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        ThrowException("LoadImage(): Could not open workload image ", filename);
+    }
+    size_t size = size_t(st.st_size);
+    void * base = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED || size < sizeof(WorkloadHeader_t)) {
+        ThrowException("LoadImage(): Could not map workload image ", filename);
+    }
+
+    const char * bytes = static_cast<const char *>(base);
+    const WorkloadHeader_t * header = reinterpret_cast<const WorkloadHeader_t *>(bytes);
+    if (header->version != WORKLOAD_VERSION ||
+        header->machines_offset + uint64_t(header->num_machines) * sizeof(WorkloadMachine_t) > size ||
+        header->tasks_offset + header->num_tasks * sizeof(WorkloadTask_t) > size) {
+        ThrowException("LoadImage(): Corrupt or incompatible workload image ", filename);
+    }
+    madvise(base, size, MADV_SEQUENTIAL);
+
+    SimOutput("LoadImage(): Loading workload image " + filename, 1);
+    const WorkloadMachine_t * machines = reinterpret_cast<const WorkloadMachine_t *>(bytes + header->machines_offset);
+    for (unsigned i = 0; i < header->num_machines; i++) {
+        const WorkloadMachine_t & m = machines[i];
+        vector<unsigned> s_states(m.s_states, m.s_states + S_STATES);
+        vector<unsigned> c_states(m.c_states, m.c_states + C_STATES);
+        vector<unsigned> p_states(m.p_states, m.p_states + P_STATES);
+        vector<unsigned> mips(m.mips, m.mips + P_STATES);
+        Machine_Add(m.memory_size, m.num_cpus, s_states, c_states, p_states, mips, m.gpus != 0, CPUType_t(m.cpu));
+    }
+
+    // The task stream is read in place from the mapping
+    const WorkloadTask_t * tasks = reinterpret_cast<const WorkloadTask_t *>(bytes + header->tasks_offset);
+    for (uint64_t i = 0; i < header->num_tasks; i++) {
+        const WorkloadTask_t & t = tasks[i];
+        AddTask(t.instructions, t.arrival, t.target, VMType_t(t.vm_type), SLAType_t(t.sla), CPUType_t(t.cpu),
+                    t.gpu != 0, t.memory, TaskClass_t(t.task_class));
+    }
+    munmap(base, size);
+
+    SimOutput("LoadImage(): Found " + to_string(GetNumTasks()) + " tasks", 1);
+    SimOutput("LoadImage(): Found " + to_string(Machine_GetTotal()) + " machines", 1);
+    InitScheduler();
+    StartStream();
+    RealStartSimulation();
+}
+
+static void WriteImage(const char * path) {
+    WorkloadHeader_t header = {};
+    memcpy(header.magic, WORKLOAD_MAGIC, sizeof(header.magic));
+    header.version = WORKLOAD_VERSION;
+    header.num_machines = unsigned(compiled_machines.size());
+    header.num_tasks = compiled_tasks.size();
+    header.machines_offset = sizeof(WorkloadHeader_t);
+    header.tasks_offset = header.machines_offset + uint64_t(header.num_machines) * sizeof(WorkloadMachine_t);
+
+    FILE * out = fopen(path, "wb");
+    if (out == nullptr) {
+        ThrowException("WriteImage(): Could not create workload image ", string(path));
+    }
+    fwrite(&header, sizeof(header), 1, out);
+    fwrite(compiled_machines.data(), sizeof(WorkloadMachine_t), compiled_machines.size(), out);
+    fwrite(compiled_tasks.data(), sizeof(WorkloadTask_t), compiled_tasks.size(), out);
+    if (fclose(out) != 0) {
+        ThrowException("WriteImage(): Could not write workload image ", string(path));
+    }
+    cout << "Compiled " << header.num_machines << " machines and " << header.num_tasks << " tasks into " << path << endl;
+}
+
+void WrapInit(string filename) {
+    if (IsImage(filename)) {
+        LoadImage(filename);
+    } else {
+        RealInit(filename);
+    }
+}
+
+void WrapMachineAdd(u_int mem, u_int cores, vector<u_int> & s_states, vector<u_int> & c_states, vector<u_int> & p_states, vector<u_int> & mips, bool gpu, CPUType_t cpu) {
+    // Machine_Add() adds one machine per call, ids are handed out in order
+    machine_s_states.push_back(s_states);
+    if (Compiling()) {
+        if (s_states.size() != S_STATES || c_states.size() != C_STATES || p_states.size() != P_STATES || mips.size() != P_STATES) {
+            ThrowException("Machine_Add(): Unexpected size of a power or performance table while compiling");
+        }
+        WorkloadMachine_t m = {};
+        m.num_cpus = cores;
+        m.memory_size = mem;
+        m.cpu = cpu;
+        m.gpus = gpu;
+        copy(s_states.begin(), s_states.end(), m.s_states);
+        copy(c_states.begin(), c_states.end(), m.c_states);
+        copy(p_states.begin(), p_states.end(), m.p_states);
+        copy(mips.begin(), mips.end(), m.mips);
+        compiled_machines.push_back(m);
+    }
+    RealMachineAdd(mem, cores, s_states, c_states, p_states, mips, gpu, cpu);
+}
+
+TaskId_t WrapAddTask(uint64_t inst, Time_t arr, Time_t trgt, VMType_t vm, SLAType_t sla, CPUType_t cpu, bool gpu, unsigned mem, TaskClass_t task_class) {
+    bool streaming = Streaming();
+    if (Compiling() || streaming) {
+        WorkloadTask_t t = {};
+        t.instructions = inst;
+        t.arrival = arr;
+        t.target = trgt;
+        t.memory = mem;
+        t.vm_type = uint8_t(vm);
+        t.sla = uint8_t(sla);
+        t.cpu = uint8_t(cpu);
+        t.gpu = gpu;
+        t.task_class = uint8_t(task_class);
+        if (streaming) {
+            // The id the task would have had, the one it gets depends on its arrival
+            stream.push_back(t);
+            return TaskId_t(stream_total++);
+        }
+        compiled_tasks.push_back(t);
+    }
+    return RealAddTask(inst, arr, trgt, vm, sla, cpu, gpu, mem, task_class);
+}
+
+// Counts the tasks held back as well
+unsigned WrapGetNumTasks() {
+    return Streaming() ? unsigned(stream_total) : RealGetNumTasks();
+}
+
+void WrapStartSimulation() {
+    const char * path = getenv("SIM_COMPILE");
+    if (path != nullptr) {
+        // Compiling only, the workload is fully generated at this point
+        WriteImage(path);
+        return;
+    }
+    StartStream();
+    RealStartSimulation();
+}
+
+/**
+ * Add the streamed tasks due within SIM_STREAM_AHEAD of now, and at least the next one while
+ * none is pending. That one keeps the simulator's timer going, which stops once no task is
+ * active. Called at start and whenever arrivals are delivered; the stream is released when
+ * the last task is added.
+ */
+void Workload_Stream(Time_t now, unsigned delivered) {
+    if (stream_next == stream.size()) {
+        return;
+    }
+    stream_pending -= min(stream_pending, uint64_t(delivered));
+    Time_t horizon = now + StreamAhead();
+    while (stream_next < stream.size() && (stream_pending == 0 || stream[stream_next].arrival <= horizon)) {
+        const WorkloadTask_t & t = stream[stream_next++];
+        RealAddTask(t.instructions, t.arrival, t.target, VMType_t(t.vm_type), SLAType_t(t.sla), CPUType_t(t.cpu),
+                    t.gpu != 0, t.memory, TaskClass_t(t.task_class));
+        stream_pending++;
+    }
+    if (stream_next == stream.size()) {
+        vector<WorkloadTask_t>().swap(stream);
+        stream_next = 0;
+    }
+}
+
+const vector<unsigned> & Workload_GetSStates(MachineId_t machine_id) {
+    static const vector<unsigned> none;
+    return machine_id < machine_s_states.size() ? machine_s_states[machine_id] : none;
+}
@@ -0,0 +1,61 @@
+//
+//  Workload.h
+//  CloudSim
+//
+
+#ifndef Workload_h
+#define Workload_h
+
+// Binary workload images. Parsing the text machine/task class format and generating the
+// task stream happens once:
+//
+//     SIM_COMPILE=workload.bin ./simulator Input.md
+//
+// and later runs load the image by mmap instead of re-parsing:
+//
+//     ./simulator workload.bin
+//
+// The image holds the expanded machine table and the generated task stream in task id
+// order, so a replay produces the same simulation as the text input it was compiled from.
+
+#include <cstdint>
+
+#include "SimTypes.h"
+
+#define WORKLOAD_MAGIC      "CSIMWL1"
+#define WORKLOAD_VERSION    1
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t num_machines;
+    uint64_t num_tasks;
+    uint64_t machines_offset;               // Byte offset of the WorkloadMachine_t array
+    uint64_t tasks_offset;                  // Byte offset of the WorkloadTask_t array
+} WorkloadHeader_t;
+
+typedef struct {
+    uint32_t num_cpus;
+    uint32_t memory_size;
+    uint32_t cpu;                           // CPUType_t
+    uint32_t gpus;
+    uint32_t s_states[S_STATES];
+    uint32_t c_states[C_STATES];
+    uint32_t p_states[P_STATES];
+    uint32_t mips[P_STATES];
+} WorkloadMachine_t;
+
+typedef struct {
+    uint64_t instructions;
+    uint64_t arrival;
+    uint64_t target;
+    uint32_t memory;
+    uint8_t vm_type;                        // VMType_t
+    uint8_t sla;                            // SLAType_t
+    uint8_t cpu;                            // CPUType_t
+    uint8_t gpu;
+    uint8_t task_class;                     // TaskClass_t
+    uint8_t padding[7];
+} WorkloadTask_t;
+
+#endif /* Workload_h */
@@ -0,0 +1,146 @@
+#!/usr/bin/env bash
+#
+#  bench.sh
+#  CloudSim
+#
+#  Runs the benchmark suite: synthetic workloads from genworkload.sh scaled from 100 to
+#  100000 machines over several arrival rates and task class mixes, and Hour.md, an hour of
+#  arrivals on 60 machines that keeps them overloaded throughout. For every run it records
+#  wall time, peak RSS, events per second, the SLA0-SLA2 violations and the total energy into
+#  one CSV table. Given a baseline table, it compares each run against it: a wall time or
+#  peak RSS above the baseline by more than the tolerance is a regression and fails the
+#  bench, a change in SLA or energy is reported since it means the schedule itself changed.
+#  Runs are one after the other so their timings do not disturb each other. Events and peak
+#  RSS come from the "Events:" line the scheduler instrumentation prints, so the simulator is
+#  built with PROFILE=1, in a scratch copy of the tree that leaves the build in it alone; a
+#  run without that line is marked noprofile and fails the bench.
+#
+#  Usage: ./bench.sh [-b baseline.csv] [-u] [-t percent] [-o results.csv] [-f filter]
+#
+#  -b  baseline to compare against (default: none, only measure)
+#  -u  write the results to the baseline instead of comparing
+#  -t  tolerance on wall time and peak RSS in percent (default: 25)
+#  -o  CSV file to write (default: standard output)
+#  -f  only run the suite entries whose name matches this pattern
+
+set -euo pipefail
+
+baseline=""
+update=0
+tolerance=25
+out="/dev/stdout"
+filter="."
+
+while getopts "b:ut:o:f:" opt; do
+    case $opt in
+        b) baseline=$OPTARG ;;
+        u) update=1 ;;
+        t) tolerance=$OPTARG ;;
+        o) out=$OPTARG ;;
+        f) filter=$OPTARG ;;
+        *) echo "Usage: $0 [-b baseline.csv] [-u] [-t percent] [-o results.csv] [-f filter]" >&2; exit 1 ;;
+    esac
+done
+if [ $update -eq 1 ] && [ -z "$baseline" ]; then
+    echo "$0: -u needs a baseline file (-b)" >&2
+    exit 1
+fi
+
+# name, machines, arrivals per second, seconds of arrivals, mix, or for an input of the tree
+# its machines, "-", "-" and the file
+suite="
+web-100        100     200   10  web
+gpu-100        100     200   10  gpu
+mixed-100      100     200   10  mixed
+web-1k         1000    1000  5   web
+gpu-1k         1000    500   5   gpu
+mixed-1k       1000    500   5   mixed
+gpu-10k        10000   1000  2   gpu
+mixed-10k      10000   1000  2   mixed
+gpu-100k       100000  10000 2   gpu
+hour           60      -     -   Hour.md
+"
+
+here=$(cd "$(dirname "$0")" && pwd)
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+# Only the prebuilt objects, those without a source, are copied, the rest is compiled afresh
+mkdir "$work/build"
+cp "$here"/Makefile "$here"/*.h "$here"/*.hpp "$here"/*.cpp "$work/build"
+for object in "$here"/*.o; do
+    [ -e "${object%.o}.cpp" ] || cp "$object" "$work/build"
+done
+make -s -C "$work/build" PROFILE=1 >&2
+cp "$work/build/simulator" "$work/simulator"
+
+header="name,machines,rate,mix,wall_seconds,peak_rss_kb,events,events_per_second,sla0,sla1,sla2,energy_kwh,status"
+echo "$header" > "$work/results.csv"
+echo "$suite" | while read -r name machines rate duration mix; do
+    if [ -z "$name" ] || ! [[ $name =~ $filter ]]; then
+        continue
+    fi
+    echo "bench: $name" >&2
+    if [[ $mix == *.md ]]; then
+        cp "$here/$mix" "$work/$name.md"
+    else
+        "$here/genworkload.sh" -m "$machines" -r "$rate" -d "$duration" -x "$mix" > "$work/$name.md"
+    fi
+    status=ok
+    start=$(date +%s.%N)
+    "$work/simulator" "$work/$name.md" > "$work/$name.log" 2>&1 || status=failed
+    end=$(date +%s.%N)
+    awk -v name="$name" -v machines="$machines" -v rate="$rate" -v mix="$mix" -v status="$status" \
+        -v start="$start" -v end="$end" '
+        /^SLA0:/ { sla0 = $2 }
+        /^SLA1:/ { sla1 = $2 }
+        /^SLA2:/ { sla2 = $2 }
+        /^Total Energy/ { energy = $3 }
+        /^Events:/ { events = $2; per_second = $3; rss = $8 }
+        /^Simulation run finished in/ { finished = 1 }
+        END {
+            gsub(/%/, "", sla0); gsub(/%/, "", sla1); gsub(/%/, "", sla2); sub(/KW-Hour/, "", energy)
+            sub(/,/, "", events)
+            if (!finished && status == "ok") status = "incomplete"
+            if (events == "" && status == "ok") status = "noprofile"
+            printf "%s,%s,%s,%s,%.3f,%s,%s,%.0f,%s,%s,%s,%s,%s\n", name, machines, rate, mix, end - start,
+                   rss, events, per_second, sla0, sla1, sla2, energy, status
+        }' "$work/$name.log" >> "$work/results.csv"
+done
+
+cp "$work/results.csv" "$out"
+if [ -z "$baseline" ]; then
+    exit 0
+fi
+if [ $update -eq 1 ]; then
+    cp "$work/results.csv" "$baseline"
+    echo "bench: baseline written to $baseline" >&2
+    exit 0
+fi
+
+# Wall times under a tenth of a second are all noise, they only count past that
+awk -F, -v tolerance="$tolerance" '
+    NR == FNR {
+        if (FNR > 1) { wall[$1] = $5; rss[$1] = $6; schedule[$1] = $9 "," $10 "," $11 "," $12 }
+        next
+    }
+    FNR == 1 { next }
+    {
+        limit = 1 + tolerance / 100
+        if ($13 != "ok") {
+            printf "FAILED     %s: %s\n", $1, $13; failed++
+        } else if (!($1 in wall)) {
+            printf "NEW        %s: %.3f s, %d KB\n", $1, $5, $6
+        } else {
+            if ($5 > wall[$1] * limit && $5 - wall[$1] > 0.1) {
+                printf "REGRESSION %s: wall %.3f s, baseline %.3f s\n", $1, $5, wall[$1]; failed++
+            }
+            if ($6 > rss[$1] * limit) {
+                printf "REGRESSION %s: peak RSS %d KB, baseline %d KB\n", $1, $6, rss[$1]; failed++
+            }
+            if ($9 "," $10 "," $11 "," $12 != schedule[$1]) {
+                printf "CHANGED    %s: SLA0-2 and energy %s, baseline %s\n", $1, $9 "," $10 "," $11 "," $12, schedule[$1]
+            }
+        }
+    }
+    END { exit failed > 0 }' "$baseline" "$work/results.csv" >&2
@@ -0,0 +1,50 @@
+#!/usr/bin/env bash
+#
+#  eventbench.sh
+#  CloudSim
+#
+#  Records the events the simulator's queue is fed on each input, with SIM_EVENT_TRACE on a
+#  PROFILE=1 build, and replays them through the event queues EventBench.cpp compares. Both
+#  are built in a scratch copy of the tree that leaves the build in it alone.
+#
+#  Usage: ./eventbench.sh [-r repeats] [input.md...]
+#
+#  -r  replays of each trace per queue, the fastest counts (default: 5)
+#
+#  The inputs default to Input.md and Hour.md.
+
+set -euo pipefail
+
+repeats=5
+
+while getopts "r:" opt; do
+    case $opt in
+        r) repeats=$OPTARG ;;
+        *) echo "Usage: $0 [-r repeats] [input.md...]" >&2; exit 1 ;;
+    esac
+done
+shift $((OPTIND - 1))
+
+here=$(cd "$(dirname "$0")" && pwd)
+if [ $# -eq 0 ]; then
+    set -- "$here/Input.md" "$here/Hour.md"
+fi
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+# Only the prebuilt objects, those without a source, are copied, the rest is compiled afresh
+mkdir "$work/build"
+cp "$here"/Makefile "$here"/*.h "$here"/*.hpp "$here"/*.cpp "$work/build"
+for object in "$here"/*.o; do
+    [ -e "${object%.o}.cpp" ] || cp "$object" "$work/build"
+done
+make -s -C "$work/build" PROFILE=1 simulator eventbench >&2
+
+traces=()
+for input in "$@"; do
+    name=$(basename "$input" .md)
+    echo "eventbench: recording $name" >&2
+    SIM_EVENT_TRACE="$work/$name.trace" "$work/build/simulator" "$input" > "$work/$name.log" 2>&1
+    traces+=("$work/$name.trace")
+done
+(cd "$work" && "$work/build/eventbench" -r "$repeats" "${traces[@]##*/}")
@@ -0,0 +1,121 @@
+#!/usr/bin/env bash
+#
+#  genworkload.sh
+#  CloudSim
+#
+#  Writes a synthetic workload in the machine class/task class format of Input.md, scaled by
+#  machine count, arrival rate and duration. The mix picks the machine classes and task classes:
+#
+#  web    X86 machines without GPUs, short SLA2 web requests over a few long SLA3 tasks
+#  gpu    X86 machines with and without GPUs, GPU-capable SLA1 crypto tasks and SLA0 HPC tasks
+#  mixed  X86, ARM and POWER machines, one X86 class with GPUs, every SLA and task type
+#
+#  Machines are split evenly over the machine classes of the mix. Each task class takes a fixed
+#  share of the arrival rate, long-running classes only a small one so the cluster is not
+#  swamped. The same parameters always give the same file.
+#
+#  Usage: ./genworkload.sh [-m machines] [-r arrivals_per_second] [-d seconds] [-x web|gpu|mixed] [-s seed]
+
+set -euo pipefail
+
+machines=100
+rate=100
+duration=60
+mix=web
+seed=1
+
+while getopts "m:r:d:x:s:" opt; do
+    case $opt in
+        m) machines=$OPTARG ;;
+        r) rate=$OPTARG ;;
+        d) duration=$OPTARG ;;
+        x) mix=$OPTARG ;;
+        s) seed=$OPTARG ;;
+        *) echo "Usage: $0 [-m machines] [-r arrivals_per_second] [-d seconds] [-x web|gpu|mixed] [-s seed]" >&2; exit 1 ;;
+    esac
+done
+
+# machine_class count cores cpu memory gpus
+machine_class() {
+    local count=$1 cores=$2 cpu=$3 memory=$4 gpus=$5
+    if [ "$count" -eq 0 ]; then
+        return
+    fi
+    if [ "$gpus" = yes ]; then
+        local s_states="[400, 300, 200, 80, 40, 10, 0]" p_states="[200, 100, 50, 20]" c_states="[100, 50, 20, 0]" mips="[10000, 8000, 6000, 4000]"
+    else
+        local s_states="[120, 100, 100, 80, 40, 10, 0]" p_states="[12, 8, 6, 4]" c_states="[12, 3, 1, 0]" mips="[1000, 800, 600, 400]"
+    fi
+    cat <<CLASS
+machine class:
+{
+        Number of machines: $count
+        CPU type: $cpu
+        Number of cores: $cores
+        Memory: $memory
+        S-States: $s_states
+        P-States: $p_states
+        C-States: $c_states
+        MIPS: $mips
+        GPUs: $gpus
+}
+CLASS
+}
+
+# task_class permille runtime_us memory vm gpu sla cpu type
+# permille is the class's share of the arrival rate, in thousandths
+task_class() {
+    local permille=$1 runtime=$2 memory=$3 vm=$4 gpu=$5 sla=$6 cpu=$7 type=$8
+    local inter_arrival=$(( 1000 * 1000000 / (rate * permille) ))
+    if [ "$inter_arrival" -lt 1 ]; then
+        inter_arrival=1
+    fi
+    task_seed=$(( task_seed + 7919 ))
+    cat <<CLASS
+task class:
+{
+        Start time: 100000
+        End time : $(( duration * 1000000 ))
+        Inter arrival: $inter_arrival
+        Expected runtime: $runtime
+        Memory: $memory
+        VM type: $vm
+        GPU enabled: $gpu
+        SLA type: $sla
+        CPU type: $cpu
+        Task type: $type
+        Seed: $task_seed
+}
+CLASS
+}
+
+task_seed=$seed
+echo "# Generated by genworkload.sh -m $machines -r $rate -d $duration -x $mix -s $seed"
+case $mix in
+    web)
+        machine_class "$machines" 8 X86 16384 no
+        task_class 980 2000000 8 LINUX no SLA2 X86 WEB
+        task_class 20 30000000 64 LINUX no SLA3 X86 STREAM
+        ;;
+    gpu)
+        machine_class $(( machines / 2 )) 16 X86 32768 no
+        machine_class $(( machines - machines / 2 )) 32 X86 65536 yes
+        task_class 500 500000 128 WIN yes SLA1 X86 CRYPTO
+        task_class 500 1000000 32 WIN no SLA0 X86 HPC
+        ;;
+    mixed)
+        machine_class $(( machines / 4 )) 8 X86 16384 no
+        machine_class $(( machines / 4 )) 32 X86 65536 yes
+        machine_class $(( machines / 4 )) 8 ARM 16384 no
+        machine_class $(( machines - 3 * (machines / 4) )) 16 POWER 32768 no
+        task_class 400 2000000 8 LINUX no SLA2 X86 WEB
+        task_class 200 500000 128 LINUX yes SLA1 X86 AI
+        task_class 200 1000000 32 LINUX_RT no SLA0 ARM HPC
+        task_class 180 4000000 64 AIX no SLA1 POWER CRYPTO
+        task_class 20 30000000 64 WIN no SLA3 X86 STREAM
+        ;;
+    *)
+        echo "Unknown mix $mix, use web, gpu or mixed" >&2
+        exit 1
+        ;;
+esac
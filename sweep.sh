@@ -0,0 +1,91 @@
+#!/usr/bin/env bash
+#
+#  sweep.sh
+#  CloudSim
+#
+#  Runs the simulator over every combination of input file, scheduling policy and seed
+#  offset, several runs at a time, and collects the SLA and energy report of each run into
+#  one CSV table. The simulator modules keep their state in globals, so every run is its
+#  own process; concurrency comes from running them side by side.
+#
+#  Usage: ./sweep.sh [-j jobs] [-p "GREEDY ROUND_ROBIN"] [-s "0 1 2"] [-o results.csv] input...
+#
+#  -j  number of simulations to run at once (default: number of cores)
+#  -p  policies to build and compare (default: GREEDY)
+#  -s  seed offsets, each is added to every "Seed:" of the input (default: 0, the input as is)
+#  -o  CSV file to write (default: standard output)
+
+set -euo pipefail
+
+jobs=$(nproc)
+policies="GREEDY"
+seeds="0"
+out="/dev/stdout"
+
+while getopts "j:p:s:o:" opt; do
+    case $opt in
+        j) jobs=$OPTARG ;;
+        p) policies=$OPTARG ;;
+        s) seeds=$OPTARG ;;
+        o) out=$OPTARG ;;
+        *) echo "Usage: $0 [-j jobs] [-p policies] [-s seeds] [-o results.csv] input..." >&2; exit 1 ;;
+    esac
+done
+shift $((OPTIND - 1))
+if [ $# -eq 0 ]; then
+    echo "Usage: $0 [-j jobs] [-p policies] [-s seeds] [-o results.csv] input..." >&2
+    exit 1
+fi
+
+here=$(cd "$(dirname "$0")" && pwd)
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+# One binary per policy, built one after the other in a scratch copy of the tree so the build
+# in the tree is left alone. Only the prebuilt objects, those without a source, are copied.
+mkdir "$work/build"
+cp "$here"/Makefile "$here"/*.h "$here"/*.hpp "$here"/*.cpp "$work/build"
+for object in "$here"/*.o; do
+    [ -e "${object%.o}.cpp" ] || cp "$object" "$work/build"
+done
+for policy in $policies; do
+    make -s -C "$work/build" POLICY="$policy" >&2
+    cp "$work/build/simulator" "$work/simulator.$policy"
+done
+
+# One input per (input, seed) pair, the seed offset shifts every task class seed
+for input in "$@"; do
+    for seed in $seeds; do
+        name="$(basename "$input" .md).$seed.md"
+        awk -v off="$seed" '/Seed:/ { sub(/[0-9]+/, $NF + off) } { print }' "$input" > "$work/$name"
+        for policy in $policies; do
+            printf '%s\t%s\t%s\t%s\n' "$input" "$policy" "$seed" "$name"
+        done
+    done
+done > "$work/runs"
+
+run_one() {
+    local work=$1 input=$2 policy=$3 seed=$4 name=$5
+    local start end status=ok
+    start=$(date +%s.%N)
+    "$work/simulator.$policy" "$work/$name" > "$work/$name.$policy.log" 2>&1 || status=failed
+    end=$(date +%s.%N)
+    awk -v input="$input" -v policy="$policy" -v seed="$seed" -v status="$status" \
+        -v start="$start" -v end="$end" '
+        /^SLA0:/ { sla0 = $2 }
+        /^SLA1:/ { sla1 = $2 }
+        /^SLA2:/ { sla2 = $2 }
+        /^Total Energy/ { energy = $3 }
+        /^Simulation run finished in/ { sim = $5 }
+        END {
+            gsub(/%/, "", sla0); gsub(/%/, "", sla1); gsub(/%/, "", sla2); sub(/KW-Hour/, "", energy)
+            if (sim == "" && status == "ok") status = "incomplete"
+            printf "%s,%s,%s,%s,%s,%s,%s,%s,%.3f,%s\n", input, policy, seed, sla0, sla1, sla2, energy, sim, end - start, status
+        }' "$work/$name.$policy.log"
+}
+export -f run_one
+
+{
+    echo "input,policy,seed,sla0,sla1,sla2,energy_kwh,sim_seconds,wall_seconds,status"
+    tr '\t' '\n' < "$work/runs" | xargs -d '\n' -n 4 -P "$jobs" bash -c 'run_one "$0" "$@"' "$work" | sort
+} > "$out"